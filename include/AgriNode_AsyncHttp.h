@@ -0,0 +1,168 @@
+/**
+ * @file AgriNode_AsyncHttp.h
+ * @brief Cliente HTTP(S) GET não bloqueante: DNS -> conexão -> TLS -> envio -> resposta
+ * @version 1.0.0
+ *
+ * Cada poll() avança só o que não bloqueia e retorna. Há prazo por etapa e
+ * prazo total. Usa sockets lwIP no ESP32 e POSIX no host; TLS (mbedTLS) só no ESP32.
+ * Não depende do Arduino.
+ *
+ * Nenhuma etapa espera pela rede, mas a CPU ainda pesa: o handshake avança
+ * um mbedtls_ssl_handshake_step() por poll(), e o passo de ECDHE ou da
+ * assinatura RSA segura o loop por algumas centenas de ms numa única chamada.
+ */
+#ifndef AGRINODE_ASYNC_HTTP_H
+#define AGRINODE_ASYNC_HTTP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef ASYNC_HTTP_TLS
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+#define ASYNC_HTTP_TLS 1
+#else
+#define ASYNC_HTTP_TLS 0
+#endif
+#endif
+
+#ifndef ASYNC_HTTP_HOST_MAX
+#define ASYNC_HTTP_HOST_MAX          64
+#endif
+#ifndef ASYNC_HTTP_REQUEST_MAX
+#define ASYNC_HTTP_REQUEST_MAX       768       // Linha GET + cabeçalhos
+#endif
+#ifndef ASYNC_HTTP_LOCATION_MAX
+#define ASYNC_HTTP_LOCATION_MAX      512       // Location do googleusercontent é longo
+#endif
+#ifndef ASYNC_HTTP_LINE_MAX
+#define ASYNC_HTTP_LINE_MAX          (ASYNC_HTTP_LOCATION_MAX + 16)
+#endif
+#ifndef ASYNC_HTTP_BODY_MAX
+#define ASYNC_HTTP_BODY_MAX          128       // Prefixo do corpo guardado (só log)
+#endif
+#ifndef ASYNC_HTTP_PHASE_TIMEOUT_MS
+#define ASYNC_HTTP_PHASE_TIMEOUT_MS  8000UL    // DNS, conexão, handshake, envio, cabeçalhos
+#endif
+#ifndef ASYNC_HTTP_TOTAL_TIMEOUT_MS
+#define ASYNC_HTTP_TOTAL_TIMEOUT_MS  15000UL
+#endif
+#ifndef ASYNC_HTTP_BODY_TIMEOUT_MS
+#define ASYNC_HTTP_BODY_TIMEOUT_MS   2000UL    // Após os cabeçalhos, para o prefixo do corpo
+#endif
+
+// Erros de transporte (<0); mesmos valores do HTTPClient quando existem lá
+enum AsyncHttpError : int {
+    ASYNC_HTTP_ERR_CONNECT  = -1,    // HTTPC_ERROR_CONNECTION_REFUSED
+    ASYNC_HTTP_ERR_SEND     = -2,    // HTTPC_ERROR_SEND_HEADER_FAILED
+    ASYNC_HTTP_ERR_LOST     = -5,    // HTTPC_ERROR_CONNECTION_LOST
+    ASYNC_HTTP_ERR_PROTOCOL = -7,    // HTTPC_ERROR_NO_HTTP_SERVER
+    ASYNC_HTTP_ERR_MEMORY   = -8,    // HTTPC_ERROR_TOO_LESS_RAM
+    ASYNC_HTTP_ERR_TIMEOUT  = -11,   // HTTPC_ERROR_READ_TIMEOUT
+    ASYNC_HTTP_ERR_DNS      = -12,
+    ASYNC_HTTP_ERR_TLS      = -13,
+    ASYNC_HTTP_ERR_URL      = -14
+};
+
+enum AsyncHttpState : uint8_t {
+    ASYNC_HTTP_IDLE = 0,
+    ASYNC_HTTP_RESOLVING,
+    ASYNC_HTTP_CONNECTING,
+    ASYNC_HTTP_HANDSHAKE,
+    ASYNC_HTTP_SENDING,
+    ASYNC_HTTP_RECEIVING,
+    ASYNC_HTTP_DONE
+};
+
+// Resolvedor chamado a cada poll() na etapa de DNS.
+// Retorno: 1 = resolvido (ip IPv4 em ordem de rede), 0 = em andamento, -1 = falhou
+typedef int8_t (*AsyncHttpResolver)(const char* host, uint32_t& ip, void* context);
+
+class AgriNodeAsyncHttp {
+public:
+    AgriNodeAsyncHttp();
+    ~AgriNodeAsyncHttp();
+
+    // Sem resolvedor: getaddrinfo() (bloqueante; aceitável só no host)
+    void setResolver(AsyncHttpResolver resolver, void* context);
+
+    // Inicia um GET; false = URL inválida/longa demais (status() já contém o erro)
+    bool get(const char* url, unsigned long now);
+
+    // Avança a requisição; true = terminou e status() é válido
+    bool poll(unsigned long now);
+
+    void abort();
+
+    bool isBusy() const { return _state != ASYNC_HTTP_IDLE && _state != ASYNC_HTTP_DONE; }
+    AsyncHttpState getState() const { return _state; }
+    static const char* stateName(AsyncHttpState state);
+
+    int getStatus() const { return _status; }              // HTTP (>0) ou AsyncHttpError (<0)
+    AsyncHttpState getFailedState() const { return _failedIn; }
+    const char* getHost() const { return _host; }
+    uint32_t getRemoteIp() const { return _ip; }
+    const char* getLocation() const { return _location; }
+    const char* getBody() const { return _body; }
+    size_t getBodyLength() const { return _bodyLen; }
+    long getContentLength() const { return _contentLength; }
+    unsigned long getElapsedMs() const { return _finishedAt - _startedAt; }
+
+private:
+    struct TlsSession;
+
+    AsyncHttpState _state;
+    AsyncHttpState _failedIn;
+    int _status;
+
+    char _host[ASYNC_HTTP_HOST_MAX];
+    uint16_t _port;
+    bool _useTls;
+    uint32_t _ip;
+    int _fd;
+    TlsSession* _tls;
+
+    AsyncHttpResolver _resolver;
+    void* _resolverContext;
+
+    char _request[ASYNC_HTTP_REQUEST_MAX];
+    size_t _requestLen;
+    size_t _sent;
+
+    // Resposta
+    char _line[ASYNC_HTTP_LINE_MAX];
+    size_t _lineLen;
+    bool _statusParsed;
+    bool _headersDone;
+    char _location[ASYNC_HTTP_LOCATION_MAX];
+    char _body[ASYNC_HTTP_BODY_MAX];
+    size_t _bodyLen;
+    long _contentLength;
+    long _bodyReceived;
+
+    unsigned long _startedAt;
+    unsigned long _phaseDeadline;
+    unsigned long _finishedAt;
+
+    bool _parseUrl(const char* url, const char*& path);
+    void _enter(AsyncHttpState state, unsigned long now, unsigned long timeoutMs);
+    void _fail(int error, unsigned long now);
+    void _finish(unsigned long now);
+    void _close();
+
+    void _stepResolve(unsigned long now);
+    void _stepConnect(unsigned long now);
+    void _stepHandshake(unsigned long now);
+    void _stepSend(unsigned long now);
+    void _stepReceive(unsigned long now);
+
+    bool _tlsBegin();
+    void _tlsEnd();
+    int _ioSend(const char* data, size_t len);
+    int _ioRecv(char* buf, size_t len);
+
+    void _consume(const char* data, size_t len);
+    bool _headerLine();
+    bool _bodyComplete() const;
+};
+
+#endif // AGRINODE_ASYNC_HTTP_H
@@ -0,0 +1,54 @@
+/**
+ * @file AgriNode_Benchmark.h
+ * @brief Micro-benchmarks no ESP32-C3 medidos com o contador de ciclos da CPU
+ * @version 1.0.0
+ *
+ * Só é usado com AGRINODE_BENCHMARK=1: o setup() roda a suíte no lugar do
+ * sistema normal. Cada caso é cronometrado BENCH_ITERATIONS vezes (após uma
+ * passada de aquecimento do cache de flash) e a tabela traz mínimo, mediana e
+ * máximo em ciclos, já descontado o custo da própria medição.
+ */
+#ifndef AGRINODE_BENCHMARK_H
+#define AGRINODE_BENCHMARK_H
+
+#include "AgriNode_Config.h"
+#include "AgriNode_Simulator.h"
+#include "AgriNode_LoRaTx.h"
+#include "AgriNode_Uplink.h"
+
+class AgriNodeBenchmark {
+public:
+    AgriNodeBenchmark(AgriNodeSimulator& simulator, AgriNodeLoRaTx& loraTx, AgriNodeUplink& uplink);
+
+    // loraReady = false pula os casos de SPI (rádio ausente)
+    void run(Print& out, bool loraReady);
+
+private:
+    typedef void (AgriNodeBenchmark::*BenchBody)(uint16_t arg);
+
+    AgriNodeSimulator& _simulator;
+    AgriNodeLoRaTx& _loraTx;
+    AgriNodeUplink& _uplink;
+    uint32_t _overhead;          // ciclos de uma medição vazia
+    uint8_t _fifo[BENCH_SPI_FIFO_BYTES];
+    float _noiseOut[BENCH_NOISE_SAMPLES];
+    AgriNodeHistory _history;    // anel próprio: não mexe no histórico do simulador
+    uint32_t _historyTime;
+
+    void _calibrate();
+    void _measure(Print& out, const char* name, uint16_t arg, BenchBody body);
+
+    void _benchEmpty(uint16_t arg);
+    void _benchPayload(uint16_t arg);
+    void _benchSensorTick(uint16_t nodes);
+    void _benchSensorTickAmbient(uint16_t nodes);
+    void _benchNoiseUniform(uint16_t samples);
+    void _benchNoiseGaussian(uint16_t samples);
+    void _benchHistoryAppend(uint16_t arg);
+    void _benchHistoryDecode(uint16_t readings);
+    void _benchUrlencode(uint16_t arg);
+    void _benchTimestamp(uint16_t arg);
+    void _benchSpiFifo(uint16_t bytes);
+};
+
+#endif // AGRINODE_BENCHMARK_H
@@ -0,0 +1,64 @@
+/**
+ * @file AgriNode_BootLog.h
+ * @brief Registro de tempos do boot (µs por fase) com histórico dos últimos boots na RTC RAM
+ * @version 1.0.0
+ *
+ * Cada fase é gravada direto no registro do boot atual, que fica num anel em
+ * memória RTC_NOINIT: um boot que trava no meio ainda aparece no histórico do
+ * próximo. O anel é validado por checksum; após power-on (RAM aleatória) recomeça.
+ */
+#ifndef AGRINODE_BOOT_LOG_H
+#define AGRINODE_BOOT_LOG_H
+
+#include "AgriNode_Config.h"
+
+// Ordem = ordem esperada no boot; as três últimas acontecem em background
+enum BootPhaseId : uint8_t {
+    BOOT_PHASE_SERIAL = 0,
+    BOOT_PHASE_LEDS,
+    BOOT_PHASE_SIMULATOR,
+    BOOT_PHASE_LORA,
+    BOOT_PHASE_DS18B20,
+    BOOT_PHASE_WIFI_START,
+    BOOT_PHASE_SETUP_DONE,
+    BOOT_PHASE_WIFI,
+    BOOT_PHASE_NTP,
+    BOOT_PHASE_FIRST_TX,
+    BOOT_PHASE_COUNT
+};
+
+struct BootRecord {
+    uint32_t bootNumber;
+    uint8_t  resetReason;                  // esp_reset_reason_t
+    // µs desde o início da app (depois do ROM e do bootloader), saturado em
+    // UINT32_MAX (~71 min); 0 = fase não alcançada
+    uint32_t phaseUs[BOOT_PHASE_COUNT];
+};
+
+class AgriNodeBootLog {
+public:
+    AgriNodeBootLog();
+
+    // Valida o anel na RTC RAM e abre o registro deste boot
+    void begin();
+    void mark(BootPhaseId phase);
+
+    bool reached(BootPhaseId phase) const;
+    const BootRecord& current() const;
+    uint8_t getHistoryCount() const;
+    // 0 = boot atual, 1 = anterior...
+    const BootRecord& getRecord(uint8_t age) const;
+
+    static const char* phaseName(BootPhaseId phase);
+    static const char* resetReasonName(uint8_t reason);
+
+    // Fases do boot atual (ms absolutos e delta entre fases do setup)
+    void printReport();
+    // Uma linha por boot: motivo do reset, fim do setup, WiFi, NTP e 1º TX
+    void printHistory();
+
+private:
+    bool _started;
+};
+
+#endif // AGRINODE_BOOT_LOG_H
@@ -0,0 +1,90 @@
+/**
+ * @file AgriNode_Checkpoint.h
+ * @brief Checkpoint incremental dos nós: base + cadeia de deltas com blocos sujos, fundida em segundo plano
+ * @version 1.0.0
+ *
+ * O simulador marca o bloco (CHECKPOINT_BLOCK_NODES slots) de cada nó
+ * alterado. A cada CHECKPOINT_INTERVAL_MS só os blocos sujos vão para um
+ * delta novo (/ckpt.<geração>), então o custo segue a atividade e não a
+ * população. Com CHECKPOINT_MERGE_AT deltas na cadeia, a tarefa copia a
+ * base e aplica os deltas em passos curtos entre as outras tarefas; a base
+ * nova entra no lugar por rename. No boot: base + deltas em ordem.
+ */
+#ifndef AGRINODE_CHECKPOINT_H
+#define AGRINODE_CHECKPOINT_H
+
+#include "AgriNode_Config.h"
+#include "AgriNode_Task.h"
+#include "AgriNode_Simulator.h"
+#include <FS.h>
+
+// Estado persistente de um nó (campos em millis() não sobrevivem ao reboot)
+struct NodeCheckpoint {
+    uint16_t nodeId;
+    uint8_t  cropType;
+    int8_t   irrigationStatus;
+    float    soilMoisture;
+    float    ambientTemp;
+    float    humidity;
+    uint32_t sequenceNumber;  // restaurado + CHECKPOINT_SEQ_ADVANCE (TXs após o último delta)
+    uint32_t txCount;
+    float    posX;
+    float    posY;
+    uint32_t check;           // FNV-1a dos campos acima; vale no lugar após a fusão
+};
+static_assert(sizeof(NodeCheckpoint) == 36, "formato do checkpoint em flash");
+
+class AgriNodeCheckpoint : public AgriNodeTask {
+public:
+    explicit AgriNodeCheckpoint(AgriNodeSimulator& simulator);
+
+    // Monta o LittleFS e restaura base + deltas no simulador (depois de simulator.begin())
+    bool begin();
+
+    // Grava os blocos sujos como próximo delta (a primeira vez, a base completa)
+    bool checkpoint();
+
+    void getStatistics(uint32_t& deltas, uint32_t& blocks, uint32_t& bytes, uint32_t& merges);
+    uint8_t getChainLength() const { return (uint8_t)(_gen - _baseGen); }
+
+protected:
+    TaskStatus run() override;
+
+private:
+    AgriNodeSimulator& _simulator;
+    bool _ready;
+    bool _hasBase;
+    uint32_t _baseGen;        // geração já incorporada à base
+    uint32_t _gen;            // último delta gravado
+
+    // Fusão em andamento (sobrevive entre retomadas da tarefa)
+    File _mergeIn;
+    File _mergeOut;
+    uint32_t _mergeUpTo;
+    uint32_t _mergeGen;
+    uint16_t _mergePos;
+    bool _mergeOk;
+
+    uint32_t _deltas;
+    uint32_t _blocksWritten;
+    uint32_t _bytesWritten;
+    uint32_t _merges;
+
+    bool _writeBase();
+    bool _writeDelta(uint16_t dirtyBlocks);
+    bool _loadFile(const char* path, uint8_t kind, uint32_t& gen);
+    void _removeDeltas(uint32_t fromGen, int8_t direction);
+    void _removeStaleDeltas();
+
+    bool _mergeBegin();
+    void _mergeCopyStep();
+    void _mergeApply(uint32_t gen);
+    void _mergeFinish();
+
+    void _restore(const NodeCheckpoint& record);
+    static NodeCheckpoint _pack(const AgriculturalNode& node);
+    static uint32_t _check(const NodeCheckpoint& record);
+    static void _deltaPath(uint32_t gen, char* path, size_t size);
+};
+
+#endif // AGRINODE_CHECKPOINT_H
@@ -11,12 +11,23 @@
 // ===================== WIFI ======================
 #define WIFI_SSID_NAME "MATHEUS "
 #define WIFI_PASSWORD  "12213490"
+#define WIFI_CONNECT_TIMEOUT_MS  25000UL
+#define WIFI_RETRY_BACKOFF_MS    5000UL
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 3000UL   // BSSID/canal/IP em cache; depois cai para scan + DHCP
+#define WIFI_CACHE_NVS_NAMESPACE "agrinet"
 
 // ===================== NTP =======================
 #define GMT_OFFSET_SEC      (-3 * 3600)   // Brasil -3
 #define DAYLIGHT_OFFSET_SEC 0
 #define NTP_SERVER_1        "pool.ntp.org"
 #define NTP_SERVER_2        "time.google.com"
+#define NTP_SYNC_TIMEOUT_MS 15000UL
+#define TIME_VALID_EPOCH_MIN 1609459200UL   // 2021-01-01: abaixo disso o relógio não foi sincronizado
+
+// ===================== BOOT ======================
+#define BOOT_SERIAL_WAIT_MS  250UL    // Espera máx. pelo monitor USB CDC (antes: delay fixo de 1500ms)
+#define BOOT_LOG_ENTRIES     8        // Boots anteriores guardados na RTC RAM (sobrevive a reset, não a power-on)
+#define TX_BOOT_STAGGER_MS   2000UL   // 1º frame de cada nó logo após o boot, escalonado
 
 // ===================== LoRa (Sincronizado com Sat) ======================
 // Pinos definidos para ESP32-C3 SuperMini (conforme seu hardware)
@@ -39,11 +50,27 @@
 
 // ================== SIMULADOR / NÓS ===============
 #define NUM_SIMULATED_NODES      5          // IDs 1000..1004
+#define NODE_ID_BASE             1000
+#define NODE_FIELD_SIZE_M        2000.0f    // Lado da área (m) onde os nós são posicionados
+#define NODE_HILBERT_ORDER       10         // Grade 1024x1024 (~2 m por célula) para ordenar os nós
 #define NODE_UPDATE_INTERVAL_MS  30000UL    // Atualização sensores
 
 #define TX_INTERVAL_BASE_MS      60000UL    // Base 60s
 #define TX_JITTER_MS             30000UL    // Variação para evitar colisão
 #define LORA_MIN_TX_INTERVAL_MS  20000UL
+#define LORA_LBT_RSSI_THRESHOLD  -90        // dBm; acima disso o canal está ocupado
+#define LORA_TX_TIMEOUT_MS       2000UL     // Prazo para o TxDone (DIO0) após endPacket
+
+// Linha de base ambiente a partir do DS18B20 real (0 = só modelo senoidal)
+#define SIM_AMBIENT_FROM_DS18B20 1
+#define SIM_AMBIENT_STALE_MS     60000UL    // Sem leitura nova nesse tempo, volta ao seno
+#define SIM_NOISE_PER_NODE       2          // Amostras gaussianas por nó a cada atualização (temp, umidade)
+
+// Contrapressão do rádio (AgriNodeLoRaTx::getTxLoad, 0..100%)
+#define SIM_BACKPRESSURE_SLOW_PCT     50    // Acima: intervalo de atualização x2
+#define SIM_BACKPRESSURE_SUMMARY_PCT  80    // Acima: modo resumo (x4; nó atualizado sob demanda antes do TX)
+#define SIM_BACKPRESSURE_SLOW_FACTOR     2
+#define SIM_BACKPRESSURE_SUMMARY_FACTOR  4
 
 // ======================= LEDs =====================
 #define LED_WIFI    9    // Verde
@@ -55,7 +82,118 @@
 // =================== DS18B20 ======================
 #define DS18B20_PIN               3
 #define DS18B20_READ_INTERVAL_MS  5000UL
+#define DS18B20_MIN_RESOLUTION    9         // 9 bits: 0.5 °C, ~94 ms
+#define DS18B20_MAX_RESOLUTION    12        // 12 bits: 0.0625 °C, ~750 ms
+#define DS18B20_STEPS_PER_DELTA   4.0f      // Variação entre ciclos deve valer >= N passos de quantização
+
+// =============== SENSORES (agendador) ==============
+#define SENSOR_ID_GATEWAY_TEMP    1         // DS18B20 do gateway (uplink + linha de base do simulador)
+#define SENSOR_ID_AIR             2         // SHT3x opcional
+
+#define SHT3X_ENABLED             0         // SuperMini tem poucos GPIOs livres: ajuste os pinos antes de ativar
+#define SHT3X_SDA_PIN             21
+#define SHT3X_SCL_PIN             20        // Conflita com LED_TX: remapeie o LED ao ativar
+#define SHT3X_ADDRESS             0x44
+#define SHT3X_READ_INTERVAL_MS    10000UL
+#define SHT3X_CONVERSION_MS       16UL      // Alta repetibilidade: 15.5 ms máx.
+
+// Pode ser sobrescrito por build flag (ex.: stand-in local em tools/sheets_standin.py)
+#ifndef GOOGLE_SHEETS_URL
 #define GOOGLE_SHEETS_URL "https://script.google.com/macros/s/AKfycbxoDKWOotFN-GQ4tJoS9HCwPDJ91s7eAWCVP4SKygeLYFX6i7J3MPZDTEIrmSdFFf4S/exec"
+#endif
+
+// ================ UPLINK (Google Sheets) ===============
+#define UPLINK_QUEUE_SIZE         24         // ~2 min de amostras a cada 5 s
+#define UPLINK_FLUSH_INTERVAL_MS  60000UL    // Janela de envio; WiFi em modem-sleep fora dela
+#define UPLINK_WAKE_LEAD_MS       300UL      // Acorda o rádio antes da janela
+#define UPLINK_WIFI_ACTIVE_MA     80.0f      // Corrente média estimada com rádio WiFi ativo (relatório de energia)
+#define UPLINK_MAX_REDIRECTS       2         // exec -> googleusercontent
+
+// Cache DNS do uplink (hostByName não expõe o TTL do registro: TTL fixo)
+#define DNS_CACHE_ENTRIES          4
+#define DNS_CACHE_HOST_MAX         48
+#define DNS_CACHE_TTL_MS           300000UL  // 5 min (TTL típico dos registros do Google)
+#define DNS_CACHE_REFRESH_AHEAD_MS 60000UL   // Renova no último minuto de validade
+#define DNS_CACHE_STALE_MAX_MS     3600000UL // IP antigo aceito por até 1 h se o resolvedor falhar
+#define DNS_CACHE_LOOKUP_TIMEOUT_MS 5000UL   // Consulta assíncrona sem resposta = falha
+
+// Token bucket + circuit breaker (AgriNodeUplinkGuard)
+// Uma janela inteira de amostras do DS18B20 (1 requisição cada) + folga para
+// drenar o atraso: com menos, a fila cresce mesmo com o backend saudável
+#define UPLINK_BUCKET_CAPACITY       (UPLINK_FLUSH_INTERVAL_MS / DS18B20_READ_INTERVAL_MS + 4)
+#define UPLINK_BUCKET_REFILL_PER_MIN 12.0f    // Taxa sustentada (requisições/min)
+#define UPLINK_BREAKER_THRESHOLD     3        // Falhas seguidas (5xx/transporte) até abrir
+#define UPLINK_BACKOFF_BASE_MS       15000UL  // Dobra a cada abertura consecutiva
+#define UPLINK_BACKOFF_QUOTA_MS      60000UL  // Base para HTTP 429 (cota do Apps Script)
+#define UPLINK_BACKOFF_MAX_MS        900000UL // Teto: 15 min
+
+// ============ LOG DE EVENTOS (LittleFS) ============
+// Transições de irrigação (liga/desliga/falha) em log binário só de anexação;
+// acima de EVENT_LOG_COMPACT_BYTES o estado vira snapshot e o log recomeça
+#define EVENT_LOG_PATH            "/events.log"
+#define EVENT_SNAPSHOT_PATH       "/events.snap"
+#define EVENT_SNAPSHOT_TMP_PATH   "/events.snap.tmp"
+#define EVENT_LOG_COMPACT_BYTES   4096      // ~170 eventos de 24 bytes
+
+// ========== CHECKPOINT INCREMENTAL (LittleFS) ==========
+// Base completa + cadeia de deltas só com os blocos de nós alterados;
+// a tarefa "ckpt" funde os deltas na base em segundo plano
+#define CHECKPOINT_BASE_PATH      "/ckpt.base"
+#define CHECKPOINT_BASE_TMP_PATH  "/ckpt.base.tmp"
+#define CHECKPOINT_DELTA_PREFIX   "/ckpt."  // + geração: /ckpt.1, /ckpt.2, ...
+#define CHECKPOINT_DELTA_TMP_PATH "/ckpt.delta.tmp"
+#define CHECKPOINT_INTERVAL_MS    300000UL  // 5 min
+// TXs que cabem entre dois checkpoints: a sequência restaurada salta isso para
+// não repetir números já recebidos depois do último delta gravado
+#define CHECKPOINT_SEQ_ADVANCE    (CHECKPOINT_INTERVAL_MS / LORA_MIN_TX_INTERVAL_MS + 1)
+#define CHECKPOINT_BLOCK_NODES    2         // Slots por bloco sujo (vizinhos na ordem de Hilbert)
+#define CHECKPOINT_BLOCKS         ((NUM_SIMULATED_NODES + CHECKPOINT_BLOCK_NODES - 1) / CHECKPOINT_BLOCK_NODES)
+#define CHECKPOINT_MERGE_AT       8         // Deltas na cadeia até fundir na base
+#define CHECKPOINT_MERGE_CHUNK    16        // Registros copiados por passo da fusão
+
+// ====== ARMAZENAMENTO DE LEITURAS (partição de flash) ======
+// Log em segmentos de um setor na partição "readings" (partitions_agrinode.csv):
+// 1 MB = 256 segmentos x 255 registros de 16 bytes (~3.5 dias com 5 nós a cada
+// 30 s + DS18B20 a cada STORE_SENSOR_INTERVAL_MS)
+#define STORE_PARTITION_LABEL     "readings"
+#define STORE_PARTITION_SUBTYPE   0x40      // Subtipo de dados livre para aplicações
+#define STORE_SEGMENT_BYTES       4096      // Setor da flash: unidade de apagamento
+#define STORE_PAGE_BYTES          256       // Página de programação: escrita em lote
+#define STORE_MAX_SEGMENTS        256       // Índice em RAM: 12 bytes por segmento
+#define STORE_FLUSH_INTERVAL_MS   60000UL   // Página parcial gravada: perda máxima numa queda
+#define STORE_SENSOR_INTERVAL_MS  30000UL   // DS18B20 lê a cada 5 s; guarda 1 a cada 30 s
+#define STORE_EXPORT_WINDOW_S     86400UL   // Console 'r': últimas 24 h
+
+// ============== MONITOR DE MEMÓRIA ================
+// Folga mínima de pilha (high-water mark) das tarefas FreeRTOS e pior caso do heap.
+// As tarefas cooperativas (AgriNode_Task) dividem a pilha do loopTask.
+#define MEMMON_INTERVAL_MS         10000UL
+#define MEMMON_STACK_WARN_BYTES    512       // Folga abaixo disso gera alerta (uma vez por tarefa)
+#define MEMMON_MAX_TASKS           10
+#define MEMMON_TASK_NAMES          "loopTask", "IDLE", "tiT", "wifi", "esp_timer", \
+                                   "sys_evt", "arduino_events", "Tmr Svc"
+
+// ============== PROFILER (diagnóstico) ==============
+// Amostra o PC interrompido num timer de hardware; ative com -DAGRINODE_PROFILER=1
+// (env esp32-c3-profile) e simbolize com tools/profile_symbolize.py
+#ifndef AGRINODE_PROFILER
+#define AGRINODE_PROFILER          0
+#endif
+#define PROFILER_SAMPLE_HZ         997       // Primo: não entra em fase com tarefas de período em ms
+#define PROFILER_TIMER_NUM         0
+#define PROFILER_SLOTS_BITS        10        // Histograma: 1024 PCs distintos (8 KB)
+#define PROFILER_PROBE_MAX         8         // Colisões toleradas antes de descartar a amostra
+#define PROFILER_DUMP_INTERVAL_MS  60000UL
+
+// ============ BENCHMARK (diagnóstico) =============
+// Com -DAGRINODE_BENCHMARK=1 (env esp32-c3-bench) o firmware não entra no loop
+// normal: mede os caminhos quentes com o contador de ciclos e imprime uma tabela
+#ifndef AGRINODE_BENCHMARK
+#define AGRINODE_BENCHMARK         0
+#endif
+#define BENCH_ITERATIONS           64        // Amostras por caso (mediana resiste a interrupções)
+#define BENCH_SPI_FIFO_BYTES       255       // Pacote LoRa máximo no FIFO do SX1276
+#define BENCH_NOISE_SAMPLES        64        // Lote de ruído: uniforme antigo x gaussiano
 
 // ================ TIPOS DE DADOS ==================
 
@@ -87,6 +225,10 @@ struct AgriculturalNode {
     uint32_t        txCount;
     int16_t         lastRssi;
     uint32_t        dataTimestamp;
+    float           ambientOffset;   // Microclima do nó em relação à referência ambiente (°C)
+    float           ambientLag;      // Inércia térmica: fração corrigida por atualização (0..1)
+    float           posX;            // Posição na área (m), 0..NODE_FIELD_SIZE_M
+    float           posY;
 };
 
 static const SensorRanges DEFAULT_SENSOR_RANGES = {
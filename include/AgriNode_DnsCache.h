@@ -0,0 +1,62 @@
+/**
+ * @file AgriNode_DnsCache.h
+ * @brief Cache DNS pequeno para os hosts do uplink (script.google.com e o host do redirect)
+ * @version 1.0.0
+ */
+#ifndef AGRINODE_DNS_CACHE_H
+#define AGRINODE_DNS_CACHE_H
+
+#include "AgriNode_Config.h"
+
+enum DnsResult : int8_t {
+    DNS_FAILED   = -1,
+    DNS_PENDING  = 0,
+    DNS_RESOLVED = 1
+};
+
+// Consulta assíncrona do lwIP; preenchida pelo callback na task do tcpip
+struct DnsLookup {
+    volatile uint8_t  state;
+    volatile uint32_t ip;
+    unsigned long     startedAt;
+};
+
+class AgriNodeDnsCache {
+public:
+    AgriNodeDnsCache();
+
+    // Não bloqueia. Entrada válida -> DNS_RESOLVED sem consulta; expirada ->
+    // dispara a consulta e devolve DNS_PENDING até a resposta. Se o resolvedor
+    // falhar, devolve o último IP conhecido (dentro de DNS_CACHE_STALE_MAX_MS)
+    DnsResult resolve(const char* host, IPAddress& ip);
+
+    // Dispara a renovação de uma entrada perto de expirar (antes da janela de envio)
+    void refreshExpiring();
+
+    // IP em cache não conectou (servidor trocou de endereço): força nova consulta
+    void invalidate(const char* host);
+
+    void getStatistics(uint32_t& hits, uint32_t& misses, uint32_t& staleServed);
+
+private:
+    struct DnsEntry {
+        char          host[DNS_CACHE_HOST_MAX];
+        uint32_t      ip;
+        unsigned long resolvedAt;
+        bool          used;
+        bool          valid;
+        DnsLookup     lookup;
+    };
+
+    DnsEntry _entries[DNS_CACHE_ENTRIES];
+    uint32_t _hits;
+    uint32_t _misses;
+    uint32_t _staleServed;
+
+    DnsEntry* _find(const char* host);
+    DnsEntry* _allocate(const char* host);
+    void _startLookup(DnsEntry& entry, unsigned long now);
+    DnsResult _harvest(DnsEntry& entry, unsigned long now);
+};
+
+#endif // AGRINODE_DNS_CACHE_H
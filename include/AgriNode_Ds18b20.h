@@ -0,0 +1,48 @@
+/**
+ * @file AgriNode_Ds18b20.h
+ * @brief Driver DS18B20 (1-Wire) não bloqueante com resolução adaptativa (9-12 bits)
+ * @version 1.0.0
+ */
+#ifndef AGRINODE_DS18B20_H
+#define AGRINODE_DS18B20_H
+
+#include "AgriNode_Config.h"
+#include "AgriNode_Sensor.h"
+#include <OneWire.h>
+#include <DallasTemperature.h>
+
+class AgriNodeDs18b20 : public AgriNodeSensorDriver {
+public:
+    // Vários DS18B20 podem dividir o mesmo barramento (index = posição na busca 1-Wire)
+    AgriNodeDs18b20(DallasTemperature& bus, uint8_t index, uint8_t sensorId);
+
+    const char* name() const override { return "ds18b20"; }
+    SensorBus bus() const override { return SENSOR_BUS_ONEWIRE; }
+    bool holdsBusWhileConverting() const override { return _parasite; }
+    unsigned long conversionMs() const override;
+
+    bool begin() override;
+    bool start(unsigned long now) override;
+    SensorPoll poll(unsigned long now) override;
+    uint8_t read(SensorReading* out, uint8_t maxReadings, unsigned long now) override;
+
+    float getLastTemp() const { return _lastTemp; }
+    uint8_t getResolution() const { return _resolution; }
+
+private:
+    DallasTemperature& _sensor;
+    uint8_t _index;
+    uint8_t _sensorId;
+    DeviceAddress _address;
+    bool _parasite;
+
+    unsigned long _convStartedAt;
+    uint8_t _resolution;
+
+    float _lastTemp;
+    bool _hasLast;
+
+    void _adaptResolution(float delta);
+};
+
+#endif // AGRINODE_DS18B20_H
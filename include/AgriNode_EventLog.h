@@ -0,0 +1,87 @@
+/**
+ * @file AgriNode_EventLog.h
+ * @brief Log binário de transições de estado dos nós (event sourcing) com compactação em snapshot
+ * @version 1.0.0
+ *
+ * Cada transição de irrigação vira um NodeEvent de 24 bytes anexado a
+ * EVENT_LOG_PATH. Quando o log passa de EVENT_LOG_COMPACT_BYTES, o estado
+ * derivado (último estado por nó) é gravado em EVENT_SNAPSHOT_PATH e o log
+ * recomeça. No boot: snapshot + eventos com seq maior = estado atual, sem
+ * precisar registrar cada tick do simulador.
+ */
+#ifndef AGRINODE_EVENT_LOG_H
+#define AGRINODE_EVENT_LOG_H
+
+#include "AgriNode_Config.h"
+
+enum NodeEventKind : uint8_t {
+    EVENT_IRRIGATION = 0      // IrrigationStatus mudou (oldState -> newState)
+};
+
+struct NodeEvent {
+    uint32_t seq;             // crescente, nunca reutilizado (continua após compactação)
+    uint32_t epoch;           // 0 = antes do NTP
+    uint32_t uptimeMs;
+    float    trigger;         // umidade do solo no momento da transição
+    uint16_t nodeId;
+    uint8_t  kind;            // NodeEventKind
+    int8_t   oldState;
+    int8_t   newState;
+    uint8_t  reserved;
+    uint16_t crc;             // CRC-16 dos campos acima: registro cortado não confere
+};
+static_assert(sizeof(NodeEvent) == 24, "formato do log em flash");
+
+// Estado derivado do log (o que o snapshot guarda)
+struct NodeEventState {
+    uint16_t nodeId;          // 0 = nó sem eventos
+    int8_t   state;
+    uint8_t  reserved;
+    uint32_t lastEpoch;
+    uint32_t transitions;
+    float    lastTrigger;
+};
+static_assert(sizeof(NodeEventState) == 16, "formato do snapshot em flash");
+
+typedef void (*NodeEventCallback)(const NodeEvent& event, void* context);
+
+class AgriNodeEventLog {
+public:
+    AgriNodeEventLog();
+
+    // Monta o LittleFS (formata se preciso), carrega o snapshot e reaplica o log
+    bool begin();
+
+    bool record(uint16_t nodeId, int8_t oldState, int8_t newState, float trigger);
+
+    // Grava o estado derivado como snapshot e zera o log; record() chama sozinho
+    bool compact();
+
+    // Reentrega os eventos do log com seq > sinceSeq (os anteriores ao último
+    // snapshot só existem como estado: getNodeState)
+    uint32_t replay(uint32_t sinceSeq, NodeEventCallback callback, void* context);
+
+    const NodeEventState* getNodeState(uint16_t nodeId) const;
+    uint32_t getLastSeq() const { return _seq; }
+
+    void printRecoveredState();
+    void getStatistics(uint32_t& logged, uint32_t& logBytes, uint32_t& compactions);
+
+private:
+    bool _ready;
+    uint32_t _seq;
+    uint32_t _snapshotSeq;
+    uint32_t _logBytes;
+    uint32_t _logged;
+    uint32_t _replayed;       // eventos do log reaplicados no boot
+    uint32_t _compactions;
+    bool _torn;               // o arquivo tem bytes além de _logBytes (escrita curta)
+    NodeEventState _states[NUM_SIMULATED_NODES];
+
+    void _apply(const NodeEvent& event);
+    bool _loadSnapshot(const char* path);
+    void _replayLog();
+    static uint16_t _crc16(const NodeEvent& event);
+};
+
+#endif // AGRINODE_EVENT_LOG_H
@@ -0,0 +1,68 @@
+/**
+ * @file AgriNode_FakeSensor.h
+ * @brief Driver de sensor simulado (host ou firmware sem hardware) para testar o agendador
+ * @version 1.0.0
+ */
+#ifndef AGRINODE_FAKE_SENSOR_H
+#define AGRINODE_FAKE_SENSOR_H
+
+#include "AgriNode_Sensor.h"
+
+class AgriNodeFakeSensor : public AgriNodeSensorDriver {
+public:
+    AgriNodeFakeSensor(uint8_t sensorId, SensorKind kind, unsigned long conversionMs,
+                       float base, float amplitude,
+                       SensorBus bus = SENSOR_BUS_VIRTUAL, bool holdsBus = false) :
+        _sensorId(sensorId), _kind(kind), _conversionMs(conversionMs),
+        _base(base), _amplitude(amplitude), _bus(bus), _holdsBus(holdsBus),
+        _failEvery(0), _startedAt(0), _cycles(0) {}
+
+    // Falha a cada N ciclos (0 = nunca), para exercitar o caminho de erro
+    void setFailEvery(uint32_t n) { _failEvery = n; }
+    uint32_t getCycles() const { return _cycles; }
+
+    const char* name() const override { return "fake"; }
+    SensorBus bus() const override { return _bus; }
+    bool holdsBusWhileConverting() const override { return _holdsBus; }
+    unsigned long conversionMs() const override { return _conversionMs; }
+
+    bool begin() override { return true; }
+
+    bool start(unsigned long now) override {
+        _startedAt = now;
+        _cycles++;
+        return true;
+    }
+
+    SensorPoll poll(unsigned long now) override {
+        if (now - _startedAt < _conversionMs) return SENSOR_BUSY;
+        if (_failEvery && (_cycles % _failEvery) == 0) return SENSOR_ERROR;
+        return SENSOR_READY;
+    }
+
+    uint8_t read(SensorReading* out, uint8_t maxReadings, unsigned long now) override {
+        if (maxReadings == 0) return 0;
+        // Onda triangular determinística com período de 16 ciclos
+        int32_t phase = (int32_t)(_cycles % 16);
+        float tri = (phase < 8 ? phase : 16 - phase) / 8.0f;
+        out[0].sensorId = _sensorId;
+        out[0].kind = _kind;
+        out[0].value = _base + _amplitude * (2.0f * tri - 1.0f);
+        out[0].takenAt = now;
+        return 1;
+    }
+
+private:
+    uint8_t _sensorId;
+    SensorKind _kind;
+    unsigned long _conversionMs;
+    float _base;
+    float _amplitude;
+    SensorBus _bus;
+    bool _holdsBus;
+    uint32_t _failEvery;
+    unsigned long _startedAt;
+    uint32_t _cycles;
+};
+
+#endif // AGRINODE_FAKE_SENSOR_H
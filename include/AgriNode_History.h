@@ -0,0 +1,87 @@
+/**
+ * @file AgriNode_History.h
+ * @brief Histórico comprimido de leituras por nó (estilo Gorilla: delta-of-delta no tempo, deltas quantizados nos valores)
+ * @version 1.0.0
+ *
+ * Cada leitura guardada crua ocupa 17 bytes (tempo + 3 floats + status).
+ * Aqui o tempo vira delta-of-delta (1 bit com período fixo) e cada valor é
+ * quantizado em 1/HISTORY_SCALE e guardado como delta com prefixo de
+ * tamanho variável; o status só ocupa bits quando muda. Com o ruído do
+ * simulador ficam ~3-4 bytes por leitura.
+ *
+ * O histórico é um anel de HISTORY_BLOCKS blocos de HISTORY_BLOCK_BYTES.
+ * Cada bloco começa com uma leitura completa e é decodificável sozinho:
+ * quando o anel enche, o bloco mais antigo é descartado inteiro.
+ *
+ * Não depende do Arduino: roda no host.
+ */
+#ifndef AGRINODE_HISTORY_H
+#define AGRINODE_HISTORY_H
+
+#include <stdint.h>
+
+#ifndef HISTORY_BLOCK_BYTES
+#define HISTORY_BLOCK_BYTES  128       // Bloco independente; perda mínima ao descartar
+#endif
+#ifndef HISTORY_BLOCKS
+#define HISTORY_BLOCKS       8         // 1 KB por nó (~2.5 h a cada 30 s)
+#endif
+#ifndef HISTORY_SCALE
+#define HISTORY_SCALE        10        // Resolução guardada: 0.1 (% ou °C)
+#endif
+
+struct HistoryReading {
+    uint32_t time;            // segundos (base escolhida por quem grava)
+    float    soilMoisture;
+    float    ambientTemp;
+    float    humidity;
+    int8_t   irrigationStatus;
+};
+
+typedef void (*HistoryCallback)(const HistoryReading& reading, void* context);
+
+class AgriNodeHistory {
+public:
+    AgriNodeHistory();
+
+    void append(const HistoryReading& reading);
+
+    // Decodifica em ordem cronológica (do bloco mais antigo ao atual)
+    uint16_t forEach(HistoryCallback callback, void* context) const;
+
+    void clear();
+
+    uint16_t size() const;               // leituras guardadas
+    uint16_t bytesUsed() const;          // bytes ocupados nos blocos
+    uint32_t getDropped() const { return _dropped; }
+
+private:
+    struct Block {
+        uint8_t  data[HISTORY_BLOCK_BYTES];
+        uint16_t bits;
+        uint16_t count;
+    };
+
+    // Estado do codificador no bloco atual
+    struct Codec {
+        uint32_t time;
+        int32_t  delta;           // último delta de tempo
+        int16_t  value[3];        // soil, temp, hum quantizados
+        int8_t   status;
+    };
+
+    Block _blocks[HISTORY_BLOCKS];
+    uint8_t _head;                // bloco em escrita
+    uint8_t _used;                // blocos com dados
+    Codec _last;
+    uint32_t _dropped;            // leituras perdidas com blocos descartados
+
+    static int16_t _quantize(float value);
+    static uint16_t _encodedBits(const Codec& last, const Codec& next);
+    static void _writeBits(Block& block, uint32_t value, uint8_t bits);
+    static uint32_t _readBits(const Block& block, uint16_t& pos, uint8_t bits);
+    static void _encode(Block& block, const Codec& last, const Codec& next);
+    static void _decode(const Block& block, uint16_t& pos, Codec& state);
+};
+
+#endif // AGRINODE_HISTORY_H
@@ -9,33 +9,62 @@
 
 #include "AgriNode_Config.h"
 #include "AgriNode_Simulator.h"
+#include "AgriNode_Task.h"
+#include "AgriNode_TxQueue.h"
 #include <LoRa.h>
 #include <vector>
 
-class AgriNodeLoRaTx {
+// Tarefa cooperativa: LBT, TX assíncrono (ISR própria no DIO0 TxDone) e LEDs sem delay().
+// Nós vencidos e alarmes entram numa fila coalescente; o rádio envia dela.
+class AgriNodeLoRaTx : public AgriNodeTask {
 public:
-    AgriNodeLoRaTx();
+    explicit AgriNodeLoRaTx(AgriNodeSimulator& simulator);
     
     bool begin();
-    void update(AgriNodeSimulator& simulator);
     
     void getStatistics(uint32_t& sent, uint32_t& failed);
+    void getQueueStatistics(uint8_t& pending, uint32_t& coalesced, uint32_t& dropped, uint32_t& alarms);
+
+    // Contrapressão (0..100%): o maior entre a ocupação da fila e a média
+    // móvel de tentativas perdidas (canal ocupado no LBT ou TX sem TxDone)
+    uint8_t getTxLoad() const;
+
+    // Folga até o próximo TX agendado (0 = há frame na fila)
+    unsigned long msUntilNextTx() const;
+
+protected:
+    TaskStatus run() override;
 
 private:
+    AgriNodeSimulator& _simulator;
     bool _initialized;
     unsigned long _lastTxTime;
+    unsigned long _startTime;
+    unsigned long _nextTxAt;
     uint32_t _packetsSent;
     uint32_t _packetsFailed;
+
+    AgriNodeTxQueue _queue;
+    uint8_t _channelBusy;         // média móvel (1/4) de tentativas perdidas, em %
+
+    // Estado da tarefa (precisa sobreviver às esperas)
+    TxFrame _frame;               // frame em transmissão (já fora da fila)
+    uint8_t _lbtSample;
+    bool _txOk;
     
     bool _initLoRa();
     void _configureLoRaParameters();
-    bool _isChannelFree();
+    void _enqueueDueNodes(unsigned long now);
+    void _recordAttempt(bool lost);
+    static TxFrame _snapshot(const AgriculturalNode& node, bool alarm, unsigned long now);
+    static void _onNodeAlarm(const AgriculturalNode& node, void* context);
     
-    bool _transmitNode(AgriculturalNode& node);
-    std::vector<uint8_t> _createBinaryPayload(const AgriculturalNode& node);
+    bool _startTransmit(const TxFrame& frame);
+    void _finishTransmit(const TxFrame& frame, bool success, unsigned long now);
+    std::vector<uint8_t> _createBinaryPayload(const TxFrame& frame);
     String _payloadToHexString(const std::vector<uint8_t>& payload);
-    
-    void _blinkLED(uint8_t times);
+
+    friend class AgriNodeBenchmark;
 };
 
 #endif // AGRINODE_LORATX_H
@@ -0,0 +1,53 @@
+/**
+ * @file AgriNode_MemoryMonitor.h
+ * @brief Folga mínima de pilha por tarefa FreeRTOS e pior caso do heap (livre e maior bloco)
+ * @version 1.0.0
+ *
+ * Amostra periodicamente uxTaskGetStackHighWaterMark das tarefas listadas em
+ * MEMMON_TASK_NAMES e o heap de 8 bits. O handle é buscado pelo nome a cada
+ * amostra: tarefas criadas depois do boot ("wifi") aparecem sozinhas e uma
+ * tarefa apagada não deixa handle pendurado. Os valores mínimos
+ * orientam o corte de pilhas superdimensionadas.
+ */
+#ifndef AGRINODE_MEMORY_MONITOR_H
+#define AGRINODE_MEMORY_MONITOR_H
+
+#include "AgriNode_Config.h"
+#include "AgriNode_Task.h"
+
+// Tarefa cooperativa: uma amostra a cada MEMMON_INTERVAL_MS
+class AgriNodeMemoryMonitor : public AgriNodeTask {
+public:
+    AgriNodeMemoryMonitor();
+
+    void begin();
+    void sample();
+
+    // Heap e tabela de pilhas (usado por printStatistics)
+    void printReport();
+
+    void getHeapStatistics(uint32_t& freeNow, uint32_t& minFree,
+                           uint32_t& largestNow, uint32_t& largestMin);
+
+protected:
+    TaskStatus run() override;
+
+private:
+    struct TaskWatch {
+        const char* name;
+        uint32_t    minFreeBytes;  // high-water mark (UINT32_MAX = tarefa nunca vista)
+        bool        running;       // encontrada na última amostra
+        bool        warned;
+    };
+
+    TaskWatch _watch[MEMMON_MAX_TASKS];
+    uint8_t _watchCount;
+
+    uint32_t _heapFree;
+    uint32_t _heapMinFree;
+    uint32_t _largestBlock;
+    uint32_t _largestBlockMin;
+    uint32_t _samples;
+};
+
+#endif // AGRINODE_MEMORY_MONITOR_H
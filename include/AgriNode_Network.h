@@ -0,0 +1,63 @@
+/**
+ * @file AgriNode_Network.h
+ * @brief WiFi + NTP não bloqueantes (máquina de estados chamada no loop)
+ * @version 1.0.0
+ */
+#ifndef AGRINODE_NETWORK_H
+#define AGRINODE_NETWORK_H
+
+#include "AgriNode_Config.h"
+#include <WiFi.h>
+
+class AgriNodeNetwork {
+public:
+    AgriNodeNetwork();
+
+    // Dispara a associação e retorna imediatamente (LoRa/simulador não esperam)
+    void begin();
+    void update();
+
+    bool isConnected() const;
+    bool isTimeSynced() const;
+
+    // Instantes (millis) em que WiFi/NTP ficaram prontos; 0 = ainda não
+    unsigned long getConnectedAt() const { return _connectedAt; }
+    unsigned long getTimeSyncedAt() const { return _timeSyncedAt; }
+
+private:
+    // Último AP/lease bem-sucedido, persistido em NVS para reconexão direta
+    struct FastConnectCache {
+        uint32_t magic;
+        uint8_t  bssid[6];
+        int32_t  channel;
+        uint32_t ip;
+        uint32_t gateway;
+        uint32_t subnet;
+        uint32_t dns;
+    };
+
+    enum NetState : uint8_t {
+        NET_IDLE = 0, NET_CONNECTING, NET_CONNECTED, NET_BACKOFF
+    };
+
+    NetState _state;
+    unsigned long _stateSince;
+    unsigned long _connectedAt;
+    unsigned long _timeSyncedAt;
+    bool _ntpStarted;
+    int _lastStatus;
+    FastConnectCache _cache;
+    bool _cacheValid;
+    bool _fastAttempt;
+
+    void _startConnect();
+    void _startFullConnect();
+    void _loadCache();
+    void _saveCache();
+    void _onConnected();
+    void _checkTimeSync();
+    void _setState(NetState state);
+    void _printStatus(int status);
+};
+
+#endif // AGRINODE_NETWORK_H
@@ -0,0 +1,48 @@
+/**
+ * @file AgriNode_Noise.h
+ * @brief Gerador de ruído gaussiano em lote (Ziggurat + xorshift32) para o simulador
+ * @version 1.0.0
+ *
+ * O ESP32-C3 não tem FPU nem SIMD: Box-Muller paga log/sqrt/sin em float
+ * emulado a cada par. No Ziggurat (Marsaglia & Tsang, 128 camadas) ~99% das
+ * amostras custam um xorshift, uma comparação inteira e uma multiplicação;
+ * exp/log só aparecem na borda das camadas. As tabelas (1.5 KB) são
+ * calculadas uma vez. Não depende do Arduino: roda no host.
+ */
+#ifndef AGRINODE_NOISE_H
+#define AGRINODE_NOISE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class AgriNodeNoise {
+public:
+    explicit AgriNodeNoise(uint32_t seed = 2463534242UL);
+
+    void seed(uint32_t seed);
+
+    // Uma amostra N(0, 1)
+    float gaussian();
+
+    // Preenche out[0..count) com N(0, 1) numa passada
+    void fill(float* out, size_t count);
+
+    // Uniforme em (0, 1), nunca 0 nem 1
+    float uniform();
+
+private:
+    uint32_t _state;
+
+    uint32_t _next() {
+        uint32_t x = _state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        _state = x;
+        return x;
+    }
+
+    float _tail(int32_t hz, uint8_t iz);
+};
+
+#endif // AGRINODE_NOISE_H
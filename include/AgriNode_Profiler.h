@@ -0,0 +1,33 @@
+/**
+ * @file AgriNode_Profiler.h
+ * @brief Profiler por amostragem: PC interrompido (timer de hardware) num histograma fixo
+ * @version 1.0.0
+ *
+ * Só é compilado com AGRINODE_PROFILER=1. O dump sai pela serial em texto e é
+ * simbolizado no host contra o firmware.elf por tools/profile_symbolize.py.
+ */
+#ifndef AGRINODE_PROFILER_H
+#define AGRINODE_PROFILER_H
+
+#include "AgriNode_Config.h"
+
+class AgriNodeProfiler {
+public:
+    AgriNodeProfiler();
+
+    bool begin(uint32_t sampleHz = PROFILER_SAMPLE_HZ);
+    void stop();
+
+    // Pausa a amostragem enquanto imprime (a própria UART não entra no perfil)
+    void dump(Print& out);
+    void reset();
+
+    void getStatistics(uint32_t& samples, uint32_t& dropped, uint16_t& usedSlots);
+
+private:
+    hw_timer_t* _timer;
+    uint32_t _sampleHz;
+    unsigned long _windowStart;
+};
+
+#endif // AGRINODE_PROFILER_H
@@ -0,0 +1,107 @@
+/**
+ * @file AgriNode_ReadingStore.h
+ * @brief Armazenamento log-structured de leituras na partição de flash "readings" (segmentos de 4 KB em anel)
+ * @version 1.0.0
+ *
+ * A partição é dividida em segmentos do tamanho de um setor (unidade de
+ * apagamento). Cada segmento começa com um cabeçalho (número de sequência) e
+ * recebe registros de 16 bytes com CRC-16, só por anexação. Os registros se
+ * acumulam numa página de RAM e vão para a flash em escritas que nunca
+ * atravessam a página de 256 bytes; a cada STORE_FLUSH_INTERVAL_MS a página
+ * parcial também é gravada (é o máximo perdido numa queda de energia).
+ *
+ * Segmentos são usados em rodízio: cada setor é apagado uma vez por volta
+ * completa (nivelamento de desgaste) e o mais antigo sai quando o anel
+ * enche. Ao fechar um segmento, o intervalo de epochs é gravado no próprio
+ * cabeçalho (bytes ainda apagados) com um CRC, então o boot só lê os
+ * cabeçalhos e o segmento atual; uma selagem cortada pela queda de energia
+ * não confere e o segmento é relido. O índice em RAM tem tamanho fixo (12 bytes por segmento)
+ * e as consultas leem a flash página a página.
+ */
+#ifndef AGRINODE_READING_STORE_H
+#define AGRINODE_READING_STORE_H
+
+#include "AgriNode_Config.h"
+#include "AgriNode_Task.h"
+#include <esp_partition.h>
+
+enum StoredReadingKind : uint8_t {
+    READING_NODE = 1,         // nó simulado: solo, temperatura, umidade
+    READING_SENSOR = 2        // sensor real do gateway (SENSOR_ID_*): value[0]
+};
+
+struct StoredReading {
+    uint32_t epoch;           // 0 = gravada antes do NTP
+    uint16_t sourceId;        // nodeId ou SENSOR_ID_*
+    uint8_t  kind;            // StoredReadingKind
+    int8_t   status;          // IrrigationStatus (nós)
+    int16_t  value[3];        // x100
+    uint16_t crc;             // CRC-16/CCITT dos 14 bytes anteriores
+};
+static_assert(sizeof(StoredReading) == 16, "formato do registro em flash");
+static_assert(STORE_PAGE_BYTES % sizeof(StoredReading) == 0, "página com registros inteiros");
+
+typedef void (*StoredReadingCallback)(const StoredReading& reading, void* context);
+
+struct StoreSegmentHeader;     // formato do slot 0, no .cpp
+
+// Tarefa cooperativa: grava a página parcial a cada STORE_FLUSH_INTERVAL_MS
+class AgriNodeReadingStore : public AgriNodeTask {
+public:
+    AgriNodeReadingStore();
+
+    // Localiza a partição e reconstrói o índice; false = armazenamento desativado
+    bool begin();
+
+    bool appendNode(const AgriculturalNode& node);
+    bool appendSample(uint16_t sensorId, float value);
+    void flush();
+
+    // Leituras com epoch em [fromEpoch, toEpoch] (fromEpoch = 0 inclui as sem
+    // epoch), do mais antigo ao mais novo; sourceId = 0 aceita todas as fontes
+    uint32_t query(uint32_t fromEpoch, uint32_t toEpoch, uint16_t sourceId,
+                   StoredReadingCallback callback, void* context);
+    void exportCsv(Print& out, uint32_t fromEpoch, uint32_t toEpoch);
+
+    void getStatistics(uint32_t& stored, uint16_t& segments, uint32_t& dropped, uint32_t& crcErrors);
+    uint16_t getSegmentCount() const { return _segmentCount; }
+
+protected:
+    TaskStatus run() override;
+
+private:
+    struct SegmentInfo {
+        uint32_t seq;             // 0 = segmento vazio
+        uint32_t minEpoch;
+        uint32_t maxEpoch;
+    };
+
+    const esp_partition_t* _partition;
+    SegmentInfo _index[STORE_MAX_SEGMENTS];
+    uint16_t _segmentCount;
+    uint16_t _head;               // segmento em escrita
+    uint16_t _writeSlot;          // próximo slot livre do head (slot 0 = cabeçalho)
+
+    StoredReading _page[STORE_PAGE_BYTES / sizeof(StoredReading)];
+    uint8_t _pageFill;
+
+    uint32_t _stored;             // registros na flash (segmentos fechados contam cheios)
+    uint32_t _dropped;            // registros perdidos com segmentos reciclados
+    uint32_t _crcErrors;
+    uint32_t _writeErrors;
+
+    bool _append(StoredReading& reading);
+    void _openSegment(uint16_t segment, uint32_t seq);
+    void _sealSegment(uint16_t segment);
+    void _advance();
+    uint16_t _scanSegment(uint16_t segment);
+    bool _matches(const StoredReading& r, uint32_t fromEpoch, uint32_t toEpoch, uint16_t sourceId) const;
+    size_t _offset(uint16_t segment, uint16_t slot) const;
+
+    static bool _isErased(const StoredReading& r);
+    static uint16_t _sealCrc(const StoreSegmentHeader& hdr);
+    static uint16_t _crc16(const uint8_t* data, size_t len);
+    static int16_t _scale(float value);
+};
+
+#endif // AGRINODE_READING_STORE_H
@@ -0,0 +1,61 @@
+/**
+ * @file AgriNode_Sensor.h
+ * @brief Interface de driver de sensor assíncrono (start / poll / read)
+ * @version 1.0.0
+ *
+ * Não depende do Arduino: drivers de teste rodam no host.
+ */
+#ifndef AGRINODE_SENSOR_H
+#define AGRINODE_SENSOR_H
+
+#include <stdint.h>
+
+enum SensorKind : uint8_t {
+    SENSOR_TEMPERATURE = 0,   // °C
+    SENSOR_HUMIDITY,          // % UR
+    SENSOR_SOIL_MOISTURE      // % volumétrico
+};
+
+enum SensorPoll : uint8_t {
+    SENSOR_BUSY = 0,          // conversão em andamento
+    SENSOR_READY,             // read() pode ser chamado
+    SENSOR_ERROR              // ciclo perdido; volta ao agendamento normal
+};
+
+// Barramentos compartilhados: o agendador não deixa duas transações exclusivas no mesmo
+enum SensorBus : uint8_t {
+    SENSOR_BUS_ONEWIRE = 0,
+    SENSOR_BUS_I2C,
+    SENSOR_BUS_VIRTUAL        // drivers de teste/host
+};
+
+struct SensorReading {
+    uint8_t       sensorId;
+    SensorKind    kind;
+    float         value;
+    unsigned long takenAt;    // millis() da leitura
+};
+
+class AgriNodeSensorDriver {
+public:
+    virtual ~AgriNodeSensorDriver() {}
+
+    virtual const char* name() const = 0;
+    virtual SensorBus bus() const = 0;
+
+    // true = barramento fica ocupado durante a conversão (ex.: 1-Wire parasita)
+    virtual bool holdsBusWhileConverting() const { return false; }
+
+    // Duração estimada da conversão (usada para encaixar na folga do LoRa)
+    virtual unsigned long conversionMs() const = 0;
+
+    virtual bool begin() = 0;
+    // Transação curta: dispara a conversão e retorna
+    virtual bool start(unsigned long now) = 0;
+    // Sem transação no barramento sempre que possível (temporizador)
+    virtual SensorPoll poll(unsigned long now) = 0;
+    // Transação de leitura; devolve quantas grandezas foram escritas em out
+    virtual uint8_t read(SensorReading* out, uint8_t maxReadings, unsigned long now) = 0;
+};
+
+#endif // AGRINODE_SENSOR_H
@@ -0,0 +1,71 @@
+/**
+ * @file AgriNode_SensorScheduler.h
+ * @brief Intercala conversões de vários sensores sem somar seus tempos de espera
+ * @version 1.0.0
+ */
+#ifndef AGRINODE_SENSOR_SCHEDULER_H
+#define AGRINODE_SENSOR_SCHEDULER_H
+
+#include "AgriNode_Sensor.h"
+
+#ifndef SENSOR_MAX_DRIVERS
+#define SENSOR_MAX_DRIVERS              16
+#endif
+#ifndef SENSOR_MAX_TRANSACTIONS_PER_TICK
+#define SENSOR_MAX_TRANSACTIONS_PER_TICK 4     // Limita o tempo gasto por chamada de update()
+#endif
+#ifndef SENSOR_MAX_DEFER_MS
+#define SENSOR_MAX_DEFER_MS             2000UL // Adiamento máx. esperando a folga do LoRa
+#endif
+#ifndef SENSOR_MAX_READINGS_PER_DRIVER
+#define SENSOR_MAX_READINGS_PER_DRIVER  4
+#endif
+
+typedef void (*SensorReadingCallback)(const SensorReading& reading, void* context);
+
+class AgriNodeSensorScheduler {
+public:
+    AgriNodeSensorScheduler();
+
+    bool add(AgriNodeSensorDriver* driver, unsigned long intervalMs);
+    void onReading(SensorReadingCallback callback, void* context);
+
+    // Inicializa os drivers; os que falharem ficam desativados
+    uint8_t begin(unsigned long now);
+
+    // quietMs: folga até a próxima atividade de rádio; conversões que não
+    // cabem nela são adiadas (até SENSOR_MAX_DEFER_MS)
+    void update(unsigned long now, unsigned long quietMs);
+
+    uint8_t getDriverCount() const { return _count; }
+    void getStatistics(uint32_t& readings, uint32_t& errors, uint32_t& deferred);
+
+private:
+    enum SlotState : uint8_t {
+        SLOT_DISABLED = 0, SLOT_IDLE, SLOT_CONVERTING
+    };
+
+    struct Slot {
+        AgriNodeSensorDriver* driver;
+        unsigned long intervalMs;
+        unsigned long dueAt;
+        SlotState state;
+        bool deferred;                // já contabilizado como adiado neste ciclo
+    };
+
+    Slot _slots[SENSOR_MAX_DRIVERS];
+    uint8_t _count;
+    uint8_t _nextStart;               // round-robin entre drivers vencidos
+
+    SensorReadingCallback _callback;
+    void* _context;
+
+    uint32_t _readings;
+    uint32_t _errors;
+    uint32_t _deferred;
+
+    bool _busHeld(SensorBus bus) const;
+    void _reschedule(Slot& slot, unsigned long now);
+};
+
+#endif // AGRINODE_SENSOR_SCHEDULER_H
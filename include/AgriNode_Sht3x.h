@@ -0,0 +1,35 @@
+/**
+ * @file AgriNode_Sht3x.h
+ * @brief Driver SHT3x (I2C) - temperatura e umidade do ar, medição single-shot
+ * @version 1.0.0
+ */
+#ifndef AGRINODE_SHT3X_H
+#define AGRINODE_SHT3X_H
+
+#include "AgriNode_Config.h"
+#include "AgriNode_Sensor.h"
+#include <Wire.h>
+
+class AgriNodeSht3x : public AgriNodeSensorDriver {
+public:
+    AgriNodeSht3x(TwoWire& wire, uint8_t address, uint8_t sensorId);
+
+    const char* name() const override { return "sht3x"; }
+    SensorBus bus() const override { return SENSOR_BUS_I2C; }
+    unsigned long conversionMs() const override { return SHT3X_CONVERSION_MS; }
+
+    bool begin() override;
+    bool start(unsigned long now) override;
+    SensorPoll poll(unsigned long now) override;
+    uint8_t read(SensorReading* out, uint8_t maxReadings, unsigned long now) override;
+
+private:
+    TwoWire& _wire;
+    uint8_t _address;
+    uint8_t _sensorId;
+    unsigned long _convStartedAt;
+
+    static uint8_t _crc8(const uint8_t* data, uint8_t len);
+};
+
+#endif // AGRINODE_SHT3X_H
@@ -7,31 +7,115 @@
 #define AGRINODE_SIMULATOR_H
 
 #include "AgriNode_Config.h"
+#include "AgriNode_Task.h"
+#include "AgriNode_Noise.h"
+#include "AgriNode_History.h"
 #include <array>
 
-class AgriNodeSimulator {
+static_assert(NUM_SIMULATED_NODES <= 127, "slots dos nós são int8_t (getSlotById)");
+
+// Irrigação ligada por umidade crítica ou falha no sistema de irrigação
+typedef void (*NodeAlarmCallback)(const AgriculturalNode& node, void* context);
+// Toda mudança de irrigationStatus (node já com o estado novo)
+typedef void (*NodeTransitionCallback)(const AgriculturalNode& node, IrrigationStatus from, void* context);
+// Cada leitura nova de um nó (tick ou atualização sob demanda)
+typedef void (*NodeUpdateCallback)(const AgriculturalNode& node, void* context);
+
+enum SimLoadMode : uint8_t {
+    SIM_MODE_NORMAL = 0,
+    SIM_MODE_SLOW,        // rádio atrasado: amostra com menos frequência
+    SIM_MODE_SUMMARY      // canal saturado: tick raro, nó atualizado só quando vai transmitir
+};
+
+// Tarefa cooperativa: atualiza os nós a cada NODE_UPDATE_INTERVAL_MS
+// (mais devagar quando o rádio sinaliza contrapressão)
+class AgriNodeSimulator : public AgriNodeTask {
 public:
     AgriNodeSimulator();
     bool begin();
-    void update();
+    void backfillTimestamps();
+    void onAlarm(NodeAlarmCallback callback, void* context);
+    void onTransition(NodeTransitionCallback callback, void* context);
+    void onUpdate(NodeUpdateCallback callback, void* context);
+
+    // Ocupação do rádio (0..100%) informada pelo loop; escolhe o SimLoadMode
+    void setTxLoad(uint8_t percent);
+    SimLoadMode getLoadMode() const { return _loadMode; }
+    static const char* loadModeName(SimLoadMode mode);
+    // Modo resumo: atualiza o nó se a leitura tem mais de NODE_UPDATE_INTERVAL_MS
+    void refreshIfStale(AgriculturalNode& node, unsigned long now);
+
+    // Temperatura real (DS18B20) usada como linha de base ambiente dos nós
+    void setAmbientBaseline(float tempC);
+    bool hasFreshAmbient() const;
     const std::array<AgriculturalNode, NUM_SIMULATED_NODES>& getNodes() const;
     AgriculturalNode& getNode(uint8_t index);
+    // Índice = slot na ordem de Hilbert, não nodeId; nullptr = ID desconhecido
+    AgriculturalNode* getNodeById(uint16_t nodeId);
+    int8_t getSlotById(uint16_t nodeId) const;
+
+    // Blocos de CHECKPOINT_BLOCK_NODES slots alterados desde o último checkpoint
+    void markDirty(const AgriculturalNode& node);
+    bool isBlockDirty(uint16_t block) const;
+    uint16_t dirtyBlockCount() const;
+    void clearDirty();
+    // Depois de restaurar posições de um checkpoint: refaz a ordem de Hilbert
+    void reorderNodes();
     void printNodeStatus(uint8_t nodeIndex);
     void printAllNodes();
 
+    // Histórico comprimido de cada nó (tempo = segundos de uptime)
+    const AgriNodeHistory* getHistory(uint16_t nodeId) const;
+    // CSV de todas as leituras guardadas, com epoch reconstruído se o NTP já sincronizou
+    void exportHistory(Print& out) const;
+    void getHistoryStatistics(uint32_t& readings, uint32_t& bytes, uint32_t& dropped) const;
+
+protected:
+    TaskStatus run() override;
+
 private:
+    // Ordenados pela curva de Hilbert da posição: vizinhos no campo ficam vizinhos na memória
     std::array<AgriculturalNode, NUM_SIMULATED_NODES> _nodes;
+    std::array<uint8_t, NUM_SIMULATED_NODES> _slotById;   // nodeId - NODE_ID_BASE -> slot
+    uint32_t _dirty[(CHECKPOINT_BLOCKS + 31) / 32];         // 1 bit por bloco
+    AgriNodeHistory _history[NUM_SIMULATED_NODES];          // por nodeId - NODE_ID_BASE
     SensorRanges _ranges;
     unsigned long _lastGlobalUpdate;
+    float _ambientBaseline;
+    unsigned long _ambientBaselineAt;
+    bool _hasAmbientBaseline;
+    NodeAlarmCallback _alarmCallback;
+    void* _alarmContext;
+    NodeTransitionCallback _transitionCallback;
+    void* _transitionContext;
+    NodeUpdateCallback _updateCallback;
+    void* _updateContext;
+    SimLoadMode _loadMode;
+
+    // Ruído do tick gerado de uma vez; reabastecido se acabar fora do tick
+    AgriNodeNoise _noise;
+    float _noiseBuf[NUM_SIMULATED_NODES * SIM_NOISE_PER_NODE];
+    uint8_t _noiseNext;
 
     void _initializeNodes();
+    void _sortNodesByHilbert();
+    void _updateAllNodes(unsigned long now);
+    void _updateNode(AgriculturalNode& node, uint32_t ts, bool fromAmbient, unsigned long now);
+    unsigned long _updateInterval() const;
+    static uint32_t _currentEpoch();
     void _updateNodeSensors(AgriculturalNode& node);
+    void _updateNodeFromAmbient(AgriculturalNode& node);
+    bool _setIrrigation(AgriculturalNode& node, IrrigationStatus status);
+    void _finishNodeSensors(AgriculturalNode& node, float tempVariation);
     void _simulateDailyVariation(AgriculturalNode& node);
     void _checkIrrigationNeeds(AgriculturalNode& node);
     float _addNoise(float value, float noisePercent);
+    float _nextNoise();
     float _constrain(float value, float min, float max);
     const char* _getCropName(CropType type);
     const char* _getIrrigationStatusName(uint8_t status);
+
+    friend class AgriNodeBenchmark;
 };
 
 #endif // AGRINODE_SIMULATOR_H
@@ -0,0 +1,141 @@
+/**
+ * @file AgriNode_Task.h
+ * @brief Tarefas cooperativas sem pilha própria (estilo protothread) para o loop principal
+ * @version 1.0.0
+ *
+ * O corpo de run() é escrito em linha reta: TASK_SLEEP / TASK_WAIT_UNTIL
+ * devolvem o controle ao loop e a execução continua no mesmo ponto na
+ * próxima chamada. Todas as tarefas dividem a pilha do loop().
+ *
+ * Restrições (o ponto de retomada é um case de switch):
+ *  - variáveis que atravessam uma espera devem ser membros da tarefa;
+ *  - não declare locais com inicializador no nível do run() entre esperas;
+ *  - não use switch próprio em volta de uma espera.
+ *
+ * Não depende do Arduino: roda no host.
+ */
+#ifndef AGRINODE_TASK_H
+#define AGRINODE_TASK_H
+
+#include <stdint.h>
+
+#ifndef TASK_MAX_TASKS
+#define TASK_MAX_TASKS   8
+#endif
+#ifndef TASK_POLL_MS
+#define TASK_POLL_MS     20UL   // Intervalo de reavaliação de TASK_WAIT_UNTIL
+#endif
+
+enum TaskStatus : uint8_t {
+    TASK_WAITING = 0,     // aguardando condição (reavaliada a cada TASK_POLL_MS)
+    TASK_SLEEPING,        // dorme até wakeAt()
+    TASK_DONE
+};
+
+class AgriNodeTask {
+public:
+    explicit AgriNodeTask(const char* name) :
+        _taskLine(0), _wakeAt(0), _now(0), _timedOut(false), _name(name) {}
+    virtual ~AgriNodeTask() {}
+
+    // Executa até a próxima espera
+    TaskStatus step(unsigned long now) {
+        _now = now;
+        return run();
+    }
+
+    void restart() { _taskLine = 0; }
+    const char* taskName() const { return _name; }
+    unsigned long wakeAt() const { return _wakeAt; }
+
+protected:
+    virtual TaskStatus run() = 0;
+
+    // millis() da retomada atual
+    unsigned long taskNow() const { return _now; }
+    // true se o último TASK_WAIT_UNTIL_TIMEOUT expirou sem a condição
+    bool taskTimedOut() const { return _timedOut; }
+
+    uint16_t _taskLine;
+    unsigned long _wakeAt;
+    unsigned long _now;
+    bool _timedOut;
+
+private:
+    const char* _name;
+};
+
+// Os pontos de retomada caem de propósito no case seguinte
+#if defined(__GNUC__) && __GNUC__ >= 7
+#define TASK_FALLTHROUGH __attribute__((fallthrough))
+#else
+#define TASK_FALLTHROUGH do {} while (0)
+#endif
+
+#define TASK_BEGIN()     switch (_taskLine) { case 0:
+
+#define TASK_END()       } _taskLine = 0; return TASK_DONE
+
+// Cede a vez e continua na próxima passada do loop
+#define TASK_YIELD() \
+    do { _taskLine = __LINE__; return TASK_WAITING; case __LINE__:; } while (0)
+
+// Dorme até o instante 'at' (millis); prazo já vencido não cede a vez
+#define TASK_SLEEP_UNTIL(at) \
+    do { \
+        _wakeAt = (unsigned long)(at); \
+        _taskLine = __LINE__; \
+        TASK_FALLTHROUGH; \
+        case __LINE__: \
+        if ((long)(_now - _wakeAt) < 0) return TASK_SLEEPING; \
+    } while (0)
+
+#define TASK_SLEEP(ms)   TASK_SLEEP_UNTIL(_now + (unsigned long)(ms))
+
+#define TASK_WAIT_UNTIL(cond) \
+    do { \
+        _taskLine = __LINE__; \
+        TASK_FALLTHROUGH; \
+        case __LINE__: \
+        if (!(cond)) return TASK_WAITING; \
+    } while (0)
+
+// Espera com prazo; consulte taskTimedOut() logo depois
+#define TASK_WAIT_UNTIL_TIMEOUT(cond, ms) \
+    do { \
+        _wakeAt = _now + (unsigned long)(ms); \
+        _taskLine = __LINE__; \
+        TASK_FALLTHROUGH; \
+        case __LINE__: \
+        _timedOut = false; \
+        if (!(cond)) { \
+            if ((long)(_now - _wakeAt) < 0) return TASK_WAITING; \
+            _timedOut = true; \
+        } \
+    } while (0)
+
+class AgriNodeTaskRunner {
+public:
+    AgriNodeTaskRunner();
+
+    bool add(AgriNodeTask* task);
+
+    // Retoma as tarefas prontas; devolve quantos ms o loop pode ficar ocioso
+    // (nunca mais que TASK_POLL_MS)
+    unsigned long update(unsigned long now);
+
+    uint8_t getTaskCount() const { return _count; }
+    void getStatistics(uint32_t& resumes, uint8_t& active);
+
+private:
+    struct Slot {
+        AgriNodeTask* task;
+        TaskStatus status;
+    };
+
+    Slot _slots[TASK_MAX_TASKS];
+    uint8_t _count;
+    uint32_t _resumes;
+};
+
+#endif // AGRINODE_TASK_H
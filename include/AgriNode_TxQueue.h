@@ -0,0 +1,72 @@
+/**
+ * @file AgriNode_TxQueue.h
+ * @brief Fila de TX LoRa limitada, por nó, em que a leitura mais nova substitui a pendente
+ * @version 1.0.0
+ *
+ * Cada nó tem no máximo um frame normal pendente: uma leitura nova atualiza
+ * esse frame no lugar (mantendo a posição na fila). Alarmes nunca são
+ * coalescidos e saem antes dos frames normais. Com a fila cheia, o frame
+ * normal mais antigo é descartado.
+ *
+ * Não depende do Arduino: roda no host.
+ */
+#ifndef AGRINODE_TX_QUEUE_H
+#define AGRINODE_TX_QUEUE_H
+
+#include <stdint.h>
+
+#ifndef TX_QUEUE_CAPACITY
+#define TX_QUEUE_CAPACITY  8         // Frames pendentes: 1 normal por nó + alarmes
+#endif
+
+// Cópia dos campos enviados no payload, tirada quando o frame entra na fila
+struct TxFrame {
+    uint16_t      nodeId;
+    float         soilMoisture;
+    float         ambientTemp;
+    float         humidity;
+    int8_t        irrigationStatus;
+    uint32_t      dataTimestamp;
+    unsigned long capturedAt;     // millis() da cópia (decide quem é mais novo)
+    bool          alarm;
+};
+
+class AgriNodeTxQueue {
+public:
+    AgriNodeTxQueue();
+
+    // false = frame descartado (fila cheia só de alarmes, ou cópia mais velha
+    // que a pendente do mesmo nó)
+    bool push(const TxFrame& frame);
+
+    // Próximo a transmitir: alarme mais antigo, senão o frame normal mais antigo
+    bool pop(TxFrame& frame);
+
+    uint8_t size() const { return _count; }
+    bool isEmpty() const { return _count == 0; }
+    bool hasPending(uint16_t nodeId) const;
+
+    // alarms conta entradas na fila (um alarme reenfileirado após falha conta de novo)
+    void getStatistics(uint32_t& coalesced, uint32_t& dropped, uint32_t& alarms);
+
+private:
+    struct Slot {
+        TxFrame  frame;
+        uint32_t order;           // ordem de chegada (FIFO dentro de cada prioridade)
+        bool     used;
+    };
+
+    Slot _slots[TX_QUEUE_CAPACITY];
+    uint8_t _count;
+    uint32_t _nextOrder;
+
+    uint32_t _coalesced;
+    uint32_t _dropped;
+    uint32_t _alarms;
+
+    int8_t _findPending(uint16_t nodeId) const;
+    int8_t _findOldest(bool alarm) const;
+    int8_t _findFree() const;
+};
+
+#endif // AGRINODE_TX_QUEUE_H
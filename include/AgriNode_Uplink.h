@@ -0,0 +1,75 @@
+/**
+ * @file AgriNode_Uplink.h
+ * @brief Uplink DS18B20 -> Google Sheets em janelas agrupadas (WiFi em modem-sleep entre elas)
+ * @version 1.0.0
+ */
+#ifndef AGRINODE_UPLINK_H
+#define AGRINODE_UPLINK_H
+
+#include "AgriNode_Config.h"
+#include "AgriNode_UplinkGuard.h"
+#include "AgriNode_DnsCache.h"
+#include "AgriNode_Network.h"
+#include "AgriNode_Task.h"
+#include "AgriNode_AsyncHttp.h"
+
+// Tarefa cooperativa: espera a janela, acorda o rádio e esvazia a fila
+class AgriNodeUplink : public AgriNodeTask {
+public:
+    explicit AgriNodeUplink(AgriNodeNetwork& network);
+
+    void begin();
+    bool enqueue(float tempC);
+
+    uint8_t getPending() const { return _count; }
+    void getStatistics(uint32_t& sent, uint32_t& failed, uint32_t& dropped);
+    AgriNodeUplinkGuard& getGuard() { return _guard; }
+    AgriNodeDnsCache& getDnsCache() { return _dns; }
+
+protected:
+    TaskStatus run() override;
+
+private:
+    struct UplinkSample {
+        float         tempC;
+        uint32_t      epoch;        // 0 = capturado antes do NTP (preenchido no envio)
+        unsigned long capturedAt;   // millis() da leitura
+    };
+
+    UplinkSample _queue[UPLINK_QUEUE_SIZE];
+    uint8_t _head;
+    uint8_t _count;
+
+    AgriNodeUplinkGuard _guard;
+    AgriNodeDnsCache _dns;
+    AgriNodeNetwork& _network;
+
+    // Requisição em andamento (redirects seguidos aqui, passando pelo cache DNS)
+    AgriNodeAsyncHttp _http;
+    char _url[ASYNC_HTTP_REQUEST_MAX];
+    uint8_t _hop;
+    unsigned long _nextFlushAt;
+    unsigned long _wokeAt;
+    bool _radioSleeping;
+
+    // Métricas da janela atual
+    uint8_t _flushSent;
+    uint8_t _flushFailed;
+    unsigned long _flushMaxAgeMs;
+
+    uint32_t _samplesSent;
+    uint32_t _samplesFailed;
+    uint32_t _samplesDropped;
+
+    void _startSample();
+    bool _onResponse();
+    bool _finishSample(int httpCode);
+    void _finishFlush(unsigned long now);
+    void _setRadioSleep(bool sleep);
+    void _formatTimestamp(const UplinkSample& sample, char* buf, size_t len);
+    static String _urlencode(const String& s);
+
+    friend class AgriNodeBenchmark;
+};
+
+#endif // AGRINODE_UPLINK_H
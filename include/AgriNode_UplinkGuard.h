@@ -0,0 +1,48 @@
+/**
+ * @file AgriNode_UplinkGuard.h
+ * @brief Token bucket + circuit breaker com backoff exponencial para o uplink HTTP
+ * @version 1.0.0
+ */
+#ifndef AGRINODE_UPLINK_GUARD_H
+#define AGRINODE_UPLINK_GUARD_H
+
+#include "AgriNode_Config.h"
+
+class AgriNodeUplinkGuard {
+public:
+    AgriNodeUplinkGuard();
+
+    void begin(unsigned long now);
+
+    // true = pode iniciar uma requisição agora (consome um token)
+    bool allowRequest(unsigned long now);
+    // Sem efeitos colaterais: true enquanto o breaker rejeita requisições (aberto)
+    bool isOpen(unsigned long now) const;
+    void onResult(int httpCode, unsigned long now);
+
+    unsigned long getRetryAt() const { return _openUntil; }
+    const char* getStateName() const;
+    void getStatistics(uint32_t& throttled, uint32_t& rejected, uint32_t& trips);
+
+private:
+    enum BreakerState : uint8_t {
+        BREAKER_CLOSED = 0, BREAKER_OPEN, BREAKER_HALF_OPEN
+    };
+
+    float _tokens;
+    unsigned long _lastRefill;
+
+    BreakerState _state;
+    uint8_t _consecutiveFailures;
+    uint8_t _backoffExp;
+    unsigned long _openUntil;
+
+    uint32_t _throttled;     // sem token
+    uint32_t _rejected;      // breaker aberto
+    uint32_t _trips;
+
+    void _refill(unsigned long now);
+    void _trip(unsigned long now, unsigned long baseMs, int httpCode);
+};
+
+#endif // AGRINODE_UPLINK_GUARD_H
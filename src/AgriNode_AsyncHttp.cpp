@@ -0,0 +1,531 @@
+/**
+ * @file AgriNode_AsyncHttp.cpp
+ * @brief GET em etapas sobre socket não bloqueante; nenhuma chamada espera a rede
+ */
+#include "AgriNode_AsyncHttp.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <new>
+
+#if defined(ARDUINO) || defined(ESP_PLATFORM)
+#include <lwip/sockets.h>
+#include <lwip/netdb.h>
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if ASYNC_HTTP_TLS
+#include <mbedtls/ssl.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+
+struct AgriNodeAsyncHttp::TlsSession {
+    mbedtls_ssl_context      ssl;
+    mbedtls_ssl_config       conf;
+    mbedtls_entropy_context  entropy;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_net_context      net;
+};
+#endif
+
+// Retornos de _ioSend/_ioRecv além da contagem de bytes
+static const int IO_WOULD_BLOCK = 0;
+static const int IO_EOF = -1;
+static const int IO_ERROR = -2;
+
+// Leituras por poll(): limita o tempo gasto mesmo com o buffer do socket cheio
+static const uint8_t RECV_CHUNKS_PER_POLL = 4;
+
+AgriNodeAsyncHttp::AgriNodeAsyncHttp() :
+    _state(ASYNC_HTTP_IDLE),
+    _failedIn(ASYNC_HTTP_IDLE),
+    _status(0),
+    _host(),
+    _port(0),
+    _useTls(false),
+    _ip(0),
+    _fd(-1),
+    _tls(nullptr),
+    _resolver(nullptr),
+    _resolverContext(nullptr),
+    _request(),
+    _requestLen(0),
+    _sent(0),
+    _line(),
+    _lineLen(0),
+    _statusParsed(false),
+    _headersDone(false),
+    _location(),
+    _body(),
+    _bodyLen(0),
+    _contentLength(-1),
+    _bodyReceived(0),
+    _startedAt(0),
+    _phaseDeadline(0),
+    _finishedAt(0)
+{
+}
+
+AgriNodeAsyncHttp::~AgriNodeAsyncHttp() {
+    _close();
+}
+
+void AgriNodeAsyncHttp::setResolver(AsyncHttpResolver resolver, void* context) {
+    _resolver = resolver;
+    _resolverContext = context;
+}
+
+const char* AgriNodeAsyncHttp::stateName(AsyncHttpState state) {
+    switch (state) {
+        case ASYNC_HTTP_IDLE:       return "IDLE";
+        case ASYNC_HTTP_RESOLVING:  return "DNS";
+        case ASYNC_HTTP_CONNECTING: return "CONNECT";
+        case ASYNC_HTTP_HANDSHAKE:  return "TLS";
+        case ASYNC_HTTP_SENDING:    return "SEND";
+        case ASYNC_HTTP_RECEIVING:  return "RECV";
+        case ASYNC_HTTP_DONE:       return "DONE";
+        default:                    return "?";
+    }
+}
+
+// ============ CICLO DE VIDA ============
+
+bool AgriNodeAsyncHttp::get(const char* url, unsigned long now) {
+    _close();
+
+    _failedIn = ASYNC_HTTP_IDLE;
+    _status = 0;
+    _ip = 0;
+    _sent = 0;
+    _lineLen = 0;
+    _statusParsed = false;
+    _headersDone = false;
+    _location[0] = '\0';
+    _body[0] = '\0';
+    _bodyLen = 0;
+    _contentLength = -1;
+    _bodyReceived = 0;
+    _startedAt = now;
+    _finishedAt = now;
+
+    const char* path = nullptr;
+    if (!_parseUrl(url, path)) {
+        _fail(ASYNC_HTTP_ERR_URL, now);
+        return false;
+    }
+#if !ASYNC_HTTP_TLS
+    if (_useTls) {
+        _fail(ASYNC_HTTP_ERR_TLS, now);
+        return false;
+    }
+#endif
+
+    // Porta fora do padrão vai no Host (o servidor monta o Location a partir dele)
+    char portSuffix[8] = "";
+    if (_port != (_useTls ? 443 : 80)) snprintf(portSuffix, sizeof(portSuffix), ":%u", _port);
+
+    // Connection: close -> fim do corpo = fim da conexão, sem drenar nada
+    int n = snprintf(_request, sizeof(_request),
+                     "GET %s%s HTTP/1.1\r\n"
+                     "Host: %s%s\r\n"
+                     "User-Agent: AgriNode\r\n"
+                     "Accept: */*\r\n"
+                     "Connection: close\r\n"
+                     "\r\n",
+                     (*path == '/') ? "" : "/", path, _host, portSuffix);
+    if (n <= 0 || (size_t)n >= sizeof(_request)) {
+        _fail(ASYNC_HTTP_ERR_URL, now);
+        return false;
+    }
+    _requestLen = (size_t)n;
+
+    _enter(ASYNC_HTTP_RESOLVING, now, ASYNC_HTTP_PHASE_TIMEOUT_MS);
+    return true;
+}
+
+bool AgriNodeAsyncHttp::poll(unsigned long now) {
+    if (_state == ASYNC_HTTP_IDLE || _state == ASYNC_HTTP_DONE) return true;
+
+    if ((long)(now - _phaseDeadline) >= 0 ||
+        now - _startedAt >= ASYNC_HTTP_TOTAL_TIMEOUT_MS) {
+        // Cabeçalhos já lidos: corpo incompleto não invalida a resposta
+        if (_headersDone) _finish(now);
+        else _fail(ASYNC_HTTP_ERR_TIMEOUT, now);
+        return true;
+    }
+
+    switch (_state) {
+        case ASYNC_HTTP_RESOLVING:  _stepResolve(now);   break;
+        case ASYNC_HTTP_CONNECTING: _stepConnect(now);   break;
+        case ASYNC_HTTP_HANDSHAKE:  _stepHandshake(now); break;
+        case ASYNC_HTTP_SENDING:    _stepSend(now);      break;
+        case ASYNC_HTTP_RECEIVING:  _stepReceive(now);   break;
+        default: break;
+    }
+    return _state == ASYNC_HTTP_DONE;
+}
+
+void AgriNodeAsyncHttp::abort() {
+    _close();
+    _state = ASYNC_HTTP_IDLE;
+}
+
+void AgriNodeAsyncHttp::_enter(AsyncHttpState state, unsigned long now, unsigned long timeoutMs) {
+    _state = state;
+    _phaseDeadline = now + timeoutMs;
+}
+
+void AgriNodeAsyncHttp::_fail(int error, unsigned long now) {
+    _failedIn = _state;
+    _status = error;
+    _finishedAt = now;
+    _close();
+    _state = ASYNC_HTTP_DONE;
+}
+
+void AgriNodeAsyncHttp::_finish(unsigned long now) {
+    _body[_bodyLen] = '\0';
+    _finishedAt = now;
+    _close();
+    _state = ASYNC_HTTP_DONE;
+}
+
+void AgriNodeAsyncHttp::_close() {
+    _tlsEnd();
+    if (_fd >= 0) {
+        close(_fd);
+        _fd = -1;
+    }
+}
+
+// ============ ETAPAS ============
+
+bool AgriNodeAsyncHttp::_parseUrl(const char* url, const char*& path) {
+    if (strncmp(url, "https://", 8) == 0) {
+        _useTls = true;
+        _port = 443;
+        url += 8;
+    } else if (strncmp(url, "http://", 7) == 0) {
+        _useTls = false;
+        _port = 80;
+        url += 7;
+    } else {
+        return false;
+    }
+
+    size_t hostLen = strcspn(url, ":/?");
+    if (hostLen == 0 || hostLen >= sizeof(_host)) return false;
+    memcpy(_host, url, hostLen);
+    _host[hostLen] = '\0';
+    url += hostLen;
+
+    if (*url == ':') {
+        char* end = nullptr;
+        long port = strtol(url + 1, &end, 10);
+        if (port <= 0 || port > 65535) return false;
+        _port = (uint16_t)port;
+        url = end;
+    }
+
+    // Caminho vazio ou só query ("?a=b"): get() prefixa a barra
+    path = url;
+    return *url == '\0' || *url == '/' || *url == '?';
+}
+
+void AgriNodeAsyncHttp::_stepResolve(unsigned long now) {
+    int8_t r;
+    if (_resolver != nullptr) {
+        r = _resolver(_host, _ip, _resolverContext);
+    } else {
+        struct addrinfo hints;
+        struct addrinfo* res = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        r = -1;
+        if (getaddrinfo(_host, nullptr, &hints, &res) == 0 && res != nullptr) {
+            _ip = ((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr;
+            r = 1;
+        }
+        if (res != nullptr) freeaddrinfo(res);
+    }
+
+    if (r == 0) return;
+    if (r < 0 || _ip == 0) {
+        _fail(ASYNC_HTTP_ERR_DNS, now);
+        return;
+    }
+
+    _fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_fd < 0) {
+        _fail(ASYNC_HTTP_ERR_MEMORY, now);
+        return;
+    }
+    fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL, 0) | O_NONBLOCK);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_port);
+    addr.sin_addr.s_addr = _ip;
+
+    if (connect(_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 && errno != EINPROGRESS) {
+        _fail(ASYNC_HTTP_ERR_CONNECT, now);
+        return;
+    }
+    _enter(ASYNC_HTTP_CONNECTING, now, ASYNC_HTTP_PHASE_TIMEOUT_MS);
+}
+
+void AgriNodeAsyncHttp::_stepConnect(unsigned long now) {
+    // Socket gravável = connect() concluiu (com sucesso ou erro em SO_ERROR)
+    fd_set wfds;
+    FD_ZERO(&wfds);
+    FD_SET(_fd, &wfds);
+    struct timeval tv = { 0, 0 };
+    if (select(_fd + 1, nullptr, &wfds, nullptr, &tv) <= 0) return;
+
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(_fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0) {
+        _fail(ASYNC_HTTP_ERR_CONNECT, now);
+        return;
+    }
+
+    if (_useTls) {
+        if (!_tlsBegin()) {
+            _fail(ASYNC_HTTP_ERR_MEMORY, now);
+            return;
+        }
+        _enter(ASYNC_HTTP_HANDSHAKE, now, ASYNC_HTTP_PHASE_TIMEOUT_MS);
+    } else {
+        _enter(ASYNC_HTTP_SENDING, now, ASYNC_HTTP_PHASE_TIMEOUT_MS);
+    }
+}
+
+void AgriNodeAsyncHttp::_stepHandshake(unsigned long now) {
+#if ASYNC_HTTP_TLS
+    // Um passo por poll(): as etapas de criptografia pesada ficam separadas
+    // por passadas do loop em vez de somadas numa chamada só
+    int r = mbedtls_ssl_handshake_step(&_tls->ssl);
+    if (r != 0 && r != MBEDTLS_ERR_SSL_WANT_READ && r != MBEDTLS_ERR_SSL_WANT_WRITE) {
+        _fail(ASYNC_HTTP_ERR_TLS, now);
+        return;
+    }
+    if (_tls->ssl.state == MBEDTLS_SSL_HANDSHAKE_OVER) {
+        _enter(ASYNC_HTTP_SENDING, now, ASYNC_HTTP_PHASE_TIMEOUT_MS);
+    }
+#else
+    _fail(ASYNC_HTTP_ERR_TLS, now);
+#endif
+}
+
+void AgriNodeAsyncHttp::_stepSend(unsigned long now) {
+    int n = _ioSend(_request + _sent, _requestLen - _sent);
+    if (n == IO_WOULD_BLOCK) return;
+    if (n < 0) {
+        _fail(ASYNC_HTTP_ERR_SEND, now);
+        return;
+    }
+    _sent += (size_t)n;
+    if (_sent == _requestLen) {
+        _enter(ASYNC_HTTP_RECEIVING, now, ASYNC_HTTP_PHASE_TIMEOUT_MS);
+    }
+}
+
+void AgriNodeAsyncHttp::_stepReceive(unsigned long now) {
+    char chunk[128];
+
+    for (uint8_t i = 0; i < RECV_CHUNKS_PER_POLL; i++) {
+        int n = _ioRecv(chunk, sizeof(chunk));
+        if (n == IO_WOULD_BLOCK) return;
+        if (n == IO_EOF) {
+            if (_headersDone) _finish(now);
+            else _fail(_statusParsed ? ASYNC_HTTP_ERR_LOST : ASYNC_HTTP_ERR_PROTOCOL, now);
+            return;
+        }
+        if (n < 0) {
+            if (_headersDone) _finish(now);
+            else _fail(ASYNC_HTTP_ERR_LOST, now);
+            return;
+        }
+
+        bool hadHeaders = _headersDone;
+        _consume(chunk, (size_t)n);
+        if (_status < 0) {
+            _fail(_status, now);
+            return;
+        }
+        if (!hadHeaders && _headersDone) {
+            // Cabeçalhos completos: o corpo só interessa como prefixo de log
+            _phaseDeadline = now + ASYNC_HTTP_BODY_TIMEOUT_MS;
+        }
+        if (_headersDone && _bodyComplete()) {
+            _finish(now);
+            return;
+        }
+    }
+}
+
+// ============ PARSER ============
+
+void AgriNodeAsyncHttp::_consume(const char* data, size_t len) {
+    size_t i = 0;
+    while (i < len && !_headersDone) {
+        char c = data[i++];
+        if (c == '\n') {
+            if (_lineLen > 0 && _line[_lineLen - 1] == '\r') _lineLen--;
+            _line[_lineLen] = '\0';
+            if (!_headerLine()) {
+                _status = ASYNC_HTTP_ERR_PROTOCOL;
+                return;
+            }
+            _lineLen = 0;
+        } else if (_lineLen < sizeof(_line) - 1) {
+            _line[_lineLen++] = c;       // linhas longas demais são truncadas
+        }
+    }
+
+    // Restante é corpo: guarda só o prefixo
+    size_t bodyBytes = len - i;
+    _bodyReceived += (long)bodyBytes;
+    size_t room = sizeof(_body) - 1 - _bodyLen;
+    if (bodyBytes > room) bodyBytes = room;
+    for (size_t k = 0; k < bodyBytes; k++) {
+        char c = data[i + k];
+        _body[_bodyLen++] = ((uint8_t)c < 0x20) ? ' ' : c;   // log em uma linha
+    }
+    _body[_bodyLen] = '\0';
+}
+
+bool AgriNodeAsyncHttp::_headerLine() {
+    if (!_statusParsed) {
+        // "HTTP/1.1 302 Moved Temporarily"; a partir do dígito da versão, que
+        // pode ser o NUL de uma linha cortada ("HTTP/1.")
+        int code = 0;
+        if (strncmp(_line, "HTTP/1.", 7) != 0 || sscanf(_line + 7, "%*c %d", &code) != 1 ||
+            code < 100 || code > 599) {
+            return false;
+        }
+        _status = code;
+        _statusParsed = true;
+        return true;
+    }
+
+    if (_lineLen == 0) {
+        _headersDone = true;
+        return true;
+    }
+
+    const char* value = strchr(_line, ':');
+    if (value == nullptr) return true;
+    size_t nameLen = (size_t)(value - _line);
+    value++;
+    while (*value == ' ' || *value == '\t') value++;
+
+    if (nameLen == 8 && strncasecmp(_line, "Location", 8) == 0) {
+        strncpy(_location, value, sizeof(_location) - 1);
+        _location[sizeof(_location) - 1] = '\0';
+    } else if (nameLen == 14 && strncasecmp(_line, "Content-Length", 14) == 0) {
+        _contentLength = strtol(value, nullptr, 10);
+    }
+    return true;
+}
+
+bool AgriNodeAsyncHttp::_bodyComplete() const {
+    if (_bodyLen >= sizeof(_body) - 1) return true;
+    if (_contentLength >= 0 && _bodyReceived >= _contentLength) return true;
+    // Sem corpo por definição
+    return _status == 204 || _status == 304 || (_status >= 100 && _status < 200);
+}
+
+// ============ E/S (TCP puro ou TLS) ============
+
+int AgriNodeAsyncHttp::_ioSend(const char* data, size_t len) {
+#if ASYNC_HTTP_TLS
+    if (_tls != nullptr) {
+        int r = mbedtls_ssl_write(&_tls->ssl, (const unsigned char*)data, len);
+        if (r == MBEDTLS_ERR_SSL_WANT_READ || r == MBEDTLS_ERR_SSL_WANT_WRITE) return IO_WOULD_BLOCK;
+        return r > 0 ? r : IO_ERROR;
+    }
+#endif
+    ssize_t r = send(_fd, data, len, 0);
+    if (r > 0) return (int)r;
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return IO_WOULD_BLOCK;
+    return IO_ERROR;
+}
+
+int AgriNodeAsyncHttp::_ioRecv(char* buf, size_t len) {
+#if ASYNC_HTTP_TLS
+    if (_tls != nullptr) {
+        int r = mbedtls_ssl_read(&_tls->ssl, (unsigned char*)buf, len);
+        if (r > 0) return r;
+        if (r == MBEDTLS_ERR_SSL_WANT_READ || r == MBEDTLS_ERR_SSL_WANT_WRITE) return IO_WOULD_BLOCK;
+        if (r == 0 || r == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) return IO_EOF;
+        return IO_ERROR;
+    }
+#endif
+    ssize_t r = recv(_fd, buf, len, 0);
+    if (r > 0) return (int)r;
+    if (r == 0) return IO_EOF;
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return IO_WOULD_BLOCK;
+    return IO_ERROR;
+}
+
+bool AgriNodeAsyncHttp::_tlsBegin() {
+#if ASYNC_HTTP_TLS
+    _tls = new (std::nothrow) TlsSession;
+    if (_tls == nullptr) return false;
+
+    mbedtls_ssl_init(&_tls->ssl);
+    mbedtls_ssl_config_init(&_tls->conf);
+    mbedtls_entropy_init(&_tls->entropy);
+    mbedtls_ctr_drbg_init(&_tls->drbg);
+    mbedtls_net_init(&_tls->net);
+    _tls->net.fd = _fd;
+
+    static const char pers[] = "agrinode_http";
+    if (mbedtls_ctr_drbg_seed(&_tls->drbg, mbedtls_entropy_func, &_tls->entropy,
+                              (const unsigned char*)pers, sizeof(pers) - 1) != 0 ||
+        mbedtls_ssl_config_defaults(&_tls->conf, MBEDTLS_SSL_IS_CLIENT,
+                                    MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT) != 0) {
+        _tlsEnd();
+        return false;
+    }
+
+    // Mesmo comportamento do setInsecure() anterior: não verifica certificado
+    mbedtls_ssl_conf_authmode(&_tls->conf, MBEDTLS_SSL_VERIFY_NONE);
+    mbedtls_ssl_conf_rng(&_tls->conf, mbedtls_ctr_drbg_random, &_tls->drbg);
+
+    if (mbedtls_ssl_setup(&_tls->ssl, &_tls->conf) != 0 ||
+        mbedtls_ssl_set_hostname(&_tls->ssl, _host) != 0) {     // SNI
+        _tlsEnd();
+        return false;
+    }
+    mbedtls_ssl_set_bio(&_tls->ssl, &_tls->net, mbedtls_net_send, mbedtls_net_recv, nullptr);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AgriNodeAsyncHttp::_tlsEnd() {
+#if ASYNC_HTTP_TLS
+    if (_tls == nullptr) return;
+    // O socket é fechado em _close(); o contexto net não é dono dele
+    mbedtls_ssl_free(&_tls->ssl);
+    mbedtls_ssl_config_free(&_tls->conf);
+    mbedtls_ctr_drbg_free(&_tls->drbg);
+    mbedtls_entropy_free(&_tls->entropy);
+    delete _tls;
+    _tls = nullptr;
+#endif
+}
@@ -0,0 +1,194 @@
+/**
+ * @file AgriNode_Benchmark.cpp
+ * @brief Suíte de micro-benchmarks (payload, simulador, uplink, SPI) em ciclos de CPU
+ */
+#include "AgriNode_Benchmark.h"
+
+#if AGRINODE_BENCHMARK
+
+// Resultados são acumulados aqui para o compilador não descartar o corpo medido
+static volatile uint32_t benchSink = 0;
+
+AgriNodeBenchmark::AgriNodeBenchmark(AgriNodeSimulator& simulator, AgriNodeLoRaTx& loraTx,
+                                     AgriNodeUplink& uplink) :
+    _simulator(simulator),
+    _loraTx(loraTx),
+    _uplink(uplink),
+    _overhead(0),
+    _noiseOut(),
+    _history(),
+    _historyTime(0)
+{
+    for (uint16_t i = 0; i < sizeof(_fifo); i++) _fifo[i] = (uint8_t)i;
+}
+
+void AgriNodeBenchmark::run(Print& out, bool loraReady) {
+    _calibrate();
+
+    out.printf("\n[BENCH] CPU %lu MHz | %d iterações por caso | overhead %lu ciclos (descontado)\n",
+               (unsigned long)getCpuFreqMHz(), BENCH_ITERATIONS, (unsigned long)_overhead);
+    out.printf("[BENCH] %-28s %6s %10s %10s %10s %10s\n",
+               "caso", "arg", "min", "mediana", "max", "us (med)");
+
+    _measure(out, "payload LoRa (encode)", 0, &AgriNodeBenchmark::_benchPayload);
+
+    // O simulador tem NUM_SIMULATED_NODES nós; contagens maiores reciclam os mesmos
+    static const uint16_t nodeCounts[] = {1, NUM_SIMULATED_NODES, 20, 50};
+    for (uint8_t i = 0; i < sizeof(nodeCounts) / sizeof(nodeCounts[0]); i++) {
+        _measure(out, "tick sensores (senoidal)", nodeCounts[i], &AgriNodeBenchmark::_benchSensorTick);
+    }
+    _simulator.setAmbientBaseline(25.0f);
+    for (uint8_t i = 0; i < sizeof(nodeCounts) / sizeof(nodeCounts[0]); i++) {
+        _measure(out, "tick sensores (DS18B20)", nodeCounts[i], &AgriNodeBenchmark::_benchSensorTickAmbient);
+    }
+
+    _measure(out, "ruído uniforme (random)", BENCH_NOISE_SAMPLES, &AgriNodeBenchmark::_benchNoiseUniform);
+    _measure(out, "ruído gaussiano (lote)", BENCH_NOISE_SAMPLES, &AgriNodeBenchmark::_benchNoiseGaussian);
+
+    // Anel cheio antes de medir: append em regime (inclui troca de bloco)
+    while (_history.getDropped() == 0) _benchHistoryAppend(0);
+    _measure(out, "histórico append", 0, &AgriNodeBenchmark::_benchHistoryAppend);
+    _measure(out, "histórico decode", _history.size(), &AgriNodeBenchmark::_benchHistoryDecode);
+
+    _measure(out, "urlencode (timestamp)", 0, &AgriNodeBenchmark::_benchUrlencode);
+    _measure(out, "formatar timestamp", 0, &AgriNodeBenchmark::_benchTimestamp);
+
+    if (loraReady) {
+        _measure(out, "FIFO SPI SX1276", 16, &AgriNodeBenchmark::_benchSpiFifo);
+        _measure(out, "FIFO SPI SX1276", BENCH_SPI_FIFO_BYTES, &AgriNodeBenchmark::_benchSpiFifo);
+        LoRa.idle();
+    } else {
+        out.println("[BENCH] FIFO SPI SX1276: pulado (LoRa não inicializado)");
+    }
+
+    out.println("[BENCH] FIM");
+}
+
+void AgriNodeBenchmark::_calibrate() {
+    uint32_t best = UINT32_MAX;
+    for (uint8_t i = 0; i < BENCH_ITERATIONS; i++) {
+        uint32_t t0 = ESP.getCycleCount();
+        _benchEmpty(0);
+        uint32_t cycles = ESP.getCycleCount() - t0;
+        if (cycles < best) best = cycles;
+    }
+    _overhead = best;
+}
+
+void AgriNodeBenchmark::_measure(Print& out, const char* name, uint16_t arg, BenchBody body) {
+    uint32_t samples[BENCH_ITERATIONS];
+
+    // Aquecimento: a primeira passada paga as faltas no cache de flash
+    (this->*body)(arg);
+
+    for (uint8_t i = 0; i < BENCH_ITERATIONS; i++) {
+        uint32_t t0 = ESP.getCycleCount();
+        (this->*body)(arg);
+        uint32_t cycles = ESP.getCycleCount() - t0;
+        samples[i] = cycles > _overhead ? cycles - _overhead : 0;
+    }
+
+    // Inserção: 64 amostras, ordenação fora da região medida
+    for (uint8_t i = 1; i < BENCH_ITERATIONS; i++) {
+        uint32_t v = samples[i];
+        int8_t j = i - 1;
+        while (j >= 0 && samples[j] > v) {
+            samples[j + 1] = samples[j];
+            j--;
+        }
+        samples[j + 1] = v;
+    }
+
+    uint32_t median = samples[BENCH_ITERATIONS / 2];
+    out.printf("[BENCH] %-28s %6u %10lu %10lu %10lu %10.2f\n",
+               name, arg,
+               (unsigned long)samples[0], (unsigned long)median,
+               (unsigned long)samples[BENCH_ITERATIONS - 1],
+               (float)median / getCpuFreqMHz());
+}
+
+void AgriNodeBenchmark::_benchEmpty(uint16_t arg) {
+    benchSink += arg;
+}
+
+void AgriNodeBenchmark::_benchPayload(uint16_t arg) {
+    // Cópia do nó para a fila + codificação, como no caminho de TX
+    TxFrame frame = AgriNodeLoRaTx::_snapshot(_simulator.getNode(0), false, 0);
+    std::vector<uint8_t> payload = _loraTx._createBinaryPayload(frame);
+    benchSink += payload.size();
+}
+
+void AgriNodeBenchmark::_benchSensorTick(uint16_t nodes) {
+    for (uint16_t i = 0; i < nodes; i++) {
+        AgriculturalNode& node = _simulator.getNode(i % NUM_SIMULATED_NODES);
+        _simulator._updateNodeSensors(node);
+        _simulator._checkIrrigationNeeds(node);
+    }
+    benchSink += nodes;
+}
+
+void AgriNodeBenchmark::_benchSensorTickAmbient(uint16_t nodes) {
+    for (uint16_t i = 0; i < nodes; i++) {
+        AgriculturalNode& node = _simulator.getNode(i % NUM_SIMULATED_NODES);
+        _simulator._updateNodeFromAmbient(node);
+        _simulator._checkIrrigationNeeds(node);
+    }
+    benchSink += nodes;
+}
+
+void AgriNodeBenchmark::_benchNoiseUniform(uint16_t samples) {
+    // Referência: o _addNoise antigo (random() do Arduino por amostra)
+    for (uint16_t i = 0; i < samples; i++) {
+        _noiseOut[i] = random(-100, 100) / 100.0;
+    }
+    benchSink += (uint32_t)_noiseOut[0];
+}
+
+void AgriNodeBenchmark::_benchNoiseGaussian(uint16_t samples) {
+    _simulator._noise.fill(_noiseOut, samples);
+    benchSink += (uint32_t)_noiseOut[0];
+}
+
+void AgriNodeBenchmark::_benchHistoryAppend(uint16_t arg) {
+    const AgriculturalNode& node = _simulator.getNode(0);
+    HistoryReading reading;
+    reading.time = (_historyTime += NODE_UPDATE_INTERVAL_MS / 1000UL);
+    reading.soilMoisture = node.soilMoisture + (_historyTime % 7) * 0.3f;
+    reading.ambientTemp = node.ambientTemp;
+    reading.humidity = node.humidity - (_historyTime % 5) * 0.2f;
+    reading.irrigationStatus = node.irrigationStatus;
+    _history.append(reading);
+    benchSink += _historyTime;
+}
+
+static void benchHistoryRow(const HistoryReading& reading, void* context) {
+    benchSink += reading.time;
+}
+
+void AgriNodeBenchmark::_benchHistoryDecode(uint16_t readings) {
+    benchSink += _history.forEach(benchHistoryRow, nullptr);
+}
+
+void AgriNodeBenchmark::_benchUrlencode(uint16_t arg) {
+    String encoded = AgriNodeUplink::_urlencode("2024-03-15 14:22:07");
+    benchSink += encoded.length();
+}
+
+void AgriNodeBenchmark::_benchTimestamp(uint16_t arg) {
+    AgriNodeUplink::UplinkSample sample;
+    sample.tempC = 25.0f;
+    sample.epoch = 1710512527UL;     // epoch válido: caminho do localtime_r
+    sample.capturedAt = 0;
+
+    char ts[20];
+    _uplink._formatTimestamp(sample, ts, sizeof(ts));
+    benchSink += (uint8_t)ts[0];
+}
+
+void AgriNodeBenchmark::_benchSpiFifo(uint16_t bytes) {
+    // beginPacket() zera o ponteiro do FIFO em standby; nada é transmitido
+    if (!LoRa.beginPacket()) return;
+    benchSink += LoRa.write(_fifo, bytes);
+}
+
+#endif // AGRINODE_BENCHMARK
@@ -0,0 +1,162 @@
+/**
+ * @file AgriNode_BootLog.cpp
+ * @brief Anel de registros de boot em RTC_NOINIT com checksum
+ */
+#include "AgriNode_BootLog.h"
+#include <esp_system.h>
+#include <esp_timer.h>
+
+#define BOOT_LOG_MAGIC    0xB0071060UL
+#define BOOT_LOG_VERSION  1                // Mude ao alterar BootRecord/BootPhaseId
+
+struct BootLogStore {
+    uint32_t   magic;
+    uint16_t   version;
+    uint8_t    head;                       // índice do boot atual
+    uint8_t    count;                      // registros válidos (<= BOOT_LOG_ENTRIES)
+    uint32_t   bootCount;
+    BootRecord records[BOOT_LOG_ENTRIES];
+    uint32_t   checksum;                   // FNV-1a de tudo acima
+};
+
+// Fora do .bss: não é zerada no reset por software, watchdog ou panic
+static RTC_NOINIT_ATTR BootLogStore bootStore;
+
+static uint32_t bootLogChecksum() {
+    const uint8_t* p = (const uint8_t*)&bootStore;
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < offsetof(BootLogStore, checksum); i++) {
+        h = (h ^ p[i]) * 16777619UL;
+    }
+    return h;
+}
+
+static const char* const bootPhaseNames[BOOT_PHASE_COUNT] = {
+    "serial", "leds", "simulator", "lora", "ds18b20",
+    "wifi_start", "setup", "wifi", "ntp", "first_tx"
+};
+
+AgriNodeBootLog::AgriNodeBootLog() :
+    _started(false)
+{
+}
+
+void AgriNodeBootLog::begin() {
+    bool valid = bootStore.magic == BOOT_LOG_MAGIC &&
+                 bootStore.version == BOOT_LOG_VERSION &&
+                 bootStore.head < BOOT_LOG_ENTRIES &&
+                 bootStore.count <= BOOT_LOG_ENTRIES &&
+                 bootStore.checksum == bootLogChecksum();
+
+    if (!valid) {
+        memset(&bootStore, 0, sizeof(bootStore));
+        bootStore.magic = BOOT_LOG_MAGIC;
+        bootStore.version = BOOT_LOG_VERSION;
+        bootStore.head = BOOT_LOG_ENTRIES - 1;   // avança para 0 abaixo
+    }
+
+    bootStore.head = (bootStore.head + 1) % BOOT_LOG_ENTRIES;
+    if (bootStore.count < BOOT_LOG_ENTRIES) bootStore.count++;
+    bootStore.bootCount++;
+
+    BootRecord& rec = bootStore.records[bootStore.head];
+    memset(&rec, 0, sizeof(rec));
+    rec.bootNumber = bootStore.bootCount;
+    rec.resetReason = (uint8_t)esp_reset_reason();
+
+    bootStore.checksum = bootLogChecksum();
+    _started = true;
+}
+
+void AgriNodeBootLog::mark(BootPhaseId phase) {
+    if (!_started || phase >= BOOT_PHASE_COUNT) return;
+    BootRecord& rec = bootStore.records[bootStore.head];
+    if (rec.phaseUs[phase] != 0) return;          // primeira ocorrência vale
+
+    // 64 bits: uma fase tardia (NTP, 1º TX) não dá a volta como micros()
+    int64_t us = esp_timer_get_time();
+    if (us > (int64_t)UINT32_MAX) us = UINT32_MAX;
+    rec.phaseUs[phase] = us > 0 ? (uint32_t)us : 1;
+    bootStore.checksum = bootLogChecksum();
+}
+
+bool AgriNodeBootLog::reached(BootPhaseId phase) const {
+    return _started && phase < BOOT_PHASE_COUNT && current().phaseUs[phase] != 0;
+}
+
+const BootRecord& AgriNodeBootLog::current() const {
+    return bootStore.records[bootStore.head];
+}
+
+uint8_t AgriNodeBootLog::getHistoryCount() const {
+    return _started ? bootStore.count : 0;
+}
+
+const BootRecord& AgriNodeBootLog::getRecord(uint8_t age) const {
+    uint8_t index = (bootStore.head + BOOT_LOG_ENTRIES - (age % BOOT_LOG_ENTRIES)) % BOOT_LOG_ENTRIES;
+    return bootStore.records[index];
+}
+
+const char* AgriNodeBootLog::phaseName(BootPhaseId phase) {
+    return phase < BOOT_PHASE_COUNT ? bootPhaseNames[phase] : "?";
+}
+
+const char* AgriNodeBootLog::resetReasonName(uint8_t reason) {
+    switch (reason) {
+        case ESP_RST_POWERON:   return "power-on";
+        case ESP_RST_EXT:       return "pino EN";
+        case ESP_RST_SW:        return "software";
+        case ESP_RST_PANIC:     return "panic";
+        case ESP_RST_INT_WDT:   return "WDT int";
+        case ESP_RST_TASK_WDT:  return "WDT tarefa";
+        case ESP_RST_WDT:       return "WDT";
+        case ESP_RST_DEEPSLEEP: return "deep sleep";
+        case ESP_RST_BROWNOUT:  return "brownout";
+        default:                return "desconhecido";
+    }
+}
+
+void AgriNodeBootLog::printReport() {
+    if (!_started) return;
+    const BootRecord& rec = current();
+
+    DEBUG_PRINTF("\n[BOOT] #%lu | reset: %s | fases (ms desde o início da app):\n",
+                 (unsigned long)rec.bootNumber, resetReasonName(rec.resetReason));
+    uint32_t prev = 0;
+    for (uint8_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+        uint32_t us = rec.phaseUs[i];
+        if (us == 0) continue;
+        // Fases em background não têm delta: rodam em paralelo ao resto
+        if (i <= BOOT_PHASE_SETUP_DONE) {
+            // ms.µs em inteiros: float perde os µs acima de 2^24 (~16.7 s)
+            DEBUG_PRINTF("  %-12s %5lu.%03lu  (+%lu.%03lu)\n", bootPhaseNames[i],
+                         (unsigned long)(us / 1000UL), (unsigned long)(us % 1000UL),
+                         (unsigned long)((us - prev) / 1000UL), (unsigned long)((us - prev) % 1000UL));
+            prev = us;
+        } else {
+            DEBUG_PRINTF("  %-12s %5lu.%03lu\n", bootPhaseNames[i],
+                         (unsigned long)(us / 1000UL), (unsigned long)(us % 1000UL));
+        }
+    }
+}
+
+void AgriNodeBootLog::printHistory() {
+    if (!_started) return;
+
+    DEBUG_PRINTF("\n[BOOT] Últimos %d boots (ms desde o início da app; - = não alcançado):\n", bootStore.count);
+    DEBUG_PRINTF("  %-6s %-13s %9s %9s %9s %9s\n", "boot", "reset", "setup", "wifi", "ntp", "1º TX");
+
+    static const BootPhaseId columns[] = {
+        BOOT_PHASE_SETUP_DONE, BOOT_PHASE_WIFI, BOOT_PHASE_NTP, BOOT_PHASE_FIRST_TX
+    };
+    for (uint8_t age = 0; age < bootStore.count; age++) {
+        const BootRecord& rec = getRecord(age);
+        DEBUG_PRINTF("  #%-5lu %-13s", (unsigned long)rec.bootNumber, resetReasonName(rec.resetReason));
+        for (uint8_t c = 0; c < sizeof(columns) / sizeof(columns[0]); c++) {
+            uint32_t us = rec.phaseUs[columns[c]];
+            if (us == 0) DEBUG_PRINTF(" %9s", "-");
+            else         DEBUG_PRINTF(" %7lu.%lu", (unsigned long)(us / 1000UL), (unsigned long)(us / 100UL % 10UL));
+        }
+        DEBUG_PRINTLN("");
+    }
+}
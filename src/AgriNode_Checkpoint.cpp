@@ -0,0 +1,431 @@
+/**
+ * @file AgriNode_Checkpoint.cpp
+ * @brief Checkpoint incremental em LittleFS: deltas de blocos sujos e fusão cooperativa na base
+ */
+#include "AgriNode_Checkpoint.h"
+#include <LittleFS.h>
+
+#define CHECKPOINT_MAGIC    0xC4E0B10CUL
+#define CHECKPOINT_VERSION  1
+
+enum CheckpointKind : uint8_t {
+    CHECKPOINT_KIND_BASE = 0,   // NUM_SIMULATED_NODES registros, índice = nodeId - NODE_ID_BASE
+    CHECKPOINT_KIND_DELTA       // só os nós dos blocos sujos, em ordem de slot
+};
+
+struct CheckpointHeader {
+    uint32_t magic;
+    uint8_t  version;
+    uint8_t  kind;
+    uint16_t count;           // registros no arquivo
+    uint32_t gen;             // base: último delta incorporado; delta: a própria geração
+    uint32_t check;
+};
+
+static uint32_t checkpointFnv(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < len; i++) h = (h ^ p[i]) * 16777619UL;
+    return h;
+}
+
+static CheckpointHeader checkpointHeader(uint8_t kind, uint16_t count, uint32_t gen) {
+    CheckpointHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = CHECKPOINT_MAGIC;
+    hdr.version = CHECKPOINT_VERSION;
+    hdr.kind = kind;
+    hdr.count = count;
+    hdr.gen = gen;
+    hdr.check = checkpointFnv(&hdr, offsetof(CheckpointHeader, check));
+    return hdr;
+}
+
+AgriNodeCheckpoint::AgriNodeCheckpoint(AgriNodeSimulator& simulator) :
+    AgriNodeTask("ckpt"),
+    _simulator(simulator),
+    _ready(false),
+    _hasBase(false),
+    _baseGen(0),
+    _gen(0),
+    _mergeUpTo(0),
+    _mergeGen(0),
+    _mergePos(0),
+    _mergeOk(false),
+    _deltas(0),
+    _blocksWritten(0),
+    _bytesWritten(0),
+    _merges(0)
+{
+}
+
+bool AgriNodeCheckpoint::begin() {
+    if (!LittleFS.begin(true)) {
+        DEBUG_PRINTLN("[CKPT] ERRO: LittleFS indisponível; checkpoint desativado");
+        return false;
+    }
+    if (LittleFS.exists(CHECKPOINT_DELTA_TMP_PATH)) LittleFS.remove(CHECKPOINT_DELTA_TMP_PATH);
+
+    // Base temporária válida só serve se a queda foi entre apagar a base e renomear
+    uint32_t gen = 0;
+    if (_loadFile(CHECKPOINT_BASE_PATH, CHECKPOINT_KIND_BASE, gen)) {
+        _hasBase = true;
+    } else if (_loadFile(CHECKPOINT_BASE_TMP_PATH, CHECKPOINT_KIND_BASE, gen)) {
+        LittleFS.rename(CHECKPOINT_BASE_TMP_PATH, CHECKPOINT_BASE_PATH);
+        _hasBase = true;
+    }
+    if (LittleFS.exists(CHECKPOINT_BASE_TMP_PATH)) LittleFS.remove(CHECKPOINT_BASE_TMP_PATH);
+
+    if (!_hasBase) {
+        _removeStaleDeltas();      // deltas sem base não têm sobre o que aplicar
+        _ready = true;
+        DEBUG_PRINTLN("[CKPT] Sem checkpoint anterior; base completa no primeiro intervalo");
+        return true;
+    }
+
+    _baseGen = _gen = gen;
+    char path[24];
+    while (true) {
+        _deltaPath(_gen + 1, path, sizeof(path));
+        if (!LittleFS.exists(path) || !_loadFile(path, CHECKPOINT_KIND_DELTA, gen) || gen != _gen + 1) break;
+        _gen++;
+    }
+    // Fora de (_baseGen, _gen]: já fundidos (queda antes da limpeza) ou depois
+    // de um delta inválido, que corta a cadeia
+    _removeStaleDeltas();
+
+    // Posições restauradas mudam a ordem de Hilbert; o estado em RAM é o do disco
+    _simulator.reorderNodes();
+    _simulator.clearDirty();
+
+    _ready = true;
+    DEBUG_PRINTF("[CKPT] Restaurado: base geração %lu + %d deltas\n",
+                 (unsigned long)_baseGen, getChainLength());
+    return true;
+}
+
+TaskStatus AgriNodeCheckpoint::run() {
+    TASK_BEGIN();
+
+    while (true) {
+        TASK_SLEEP(CHECKPOINT_INTERVAL_MS);
+        if (!_ready) continue;
+
+        checkpoint();
+        if (getChainLength() < CHECKPOINT_MERGE_AT || !_mergeBegin()) continue;
+
+        // Fusão em pedaços: cada passo cede a vez para LoRa e simulador
+        while (_mergeOk && _mergePos < NUM_SIMULATED_NODES) {
+            _mergeCopyStep();
+            TASK_YIELD();
+        }
+        for (_mergeGen = _baseGen + 1; _mergeOk && _mergeGen <= _mergeUpTo; _mergeGen++) {
+            _mergeApply(_mergeGen);
+            TASK_YIELD();
+        }
+        _mergeFinish();
+    }
+
+    TASK_END();
+}
+
+bool AgriNodeCheckpoint::checkpoint() {
+    if (!_ready) return false;
+    if (!_hasBase) return _writeBase();
+
+    uint16_t dirty = _simulator.dirtyBlockCount();
+    if (dirty == 0) return true;   // nada mudou: nem abre arquivo
+    return _writeDelta(dirty);
+}
+
+bool AgriNodeCheckpoint::_writeBase() {
+    File f = LittleFS.open(CHECKPOINT_BASE_TMP_PATH, "w");
+    if (!f) return false;
+
+    CheckpointHeader hdr = checkpointHeader(CHECKPOINT_KIND_BASE, NUM_SIMULATED_NODES, _gen);
+    bool ok = f.write((const uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr);
+    for (uint16_t i = 0; ok && i < NUM_SIMULATED_NODES; i++) {
+        NodeCheckpoint rec = _pack(*_simulator.getNodeById(NODE_ID_BASE + i));
+        ok = f.write((const uint8_t*)&rec, sizeof(rec)) == sizeof(rec);
+    }
+    f.close();
+
+    if (!ok) {
+        LittleFS.remove(CHECKPOINT_BASE_TMP_PATH);
+        DEBUG_PRINTLN("[CKPT] ERRO: falha ao gravar a base");
+        return false;
+    }
+    LittleFS.rename(CHECKPOINT_BASE_TMP_PATH, CHECKPOINT_BASE_PATH);
+
+    _hasBase = true;
+    _baseGen = _gen;
+    _blocksWritten += CHECKPOINT_BLOCKS;
+    _bytesWritten += sizeof(hdr) + NUM_SIMULATED_NODES * sizeof(NodeCheckpoint);
+    _simulator.clearDirty();
+    DEBUG_PRINTF("[CKPT] Base completa gravada (%d nós)\n", NUM_SIMULATED_NODES);
+    return true;
+}
+
+bool AgriNodeCheckpoint::_writeDelta(uint16_t dirtyBlocks) {
+    uint16_t count = 0;
+    for (uint16_t b = 0; b < CHECKPOINT_BLOCKS; b++) {
+        if (!_simulator.isBlockDirty(b)) continue;
+        uint16_t first = b * CHECKPOINT_BLOCK_NODES;
+        uint16_t last = first + CHECKPOINT_BLOCK_NODES;
+        if (last > NUM_SIMULATED_NODES) last = NUM_SIMULATED_NODES;
+        count += last - first;
+    }
+
+    File f = LittleFS.open(CHECKPOINT_DELTA_TMP_PATH, "w");
+    if (!f) return false;
+
+    CheckpointHeader hdr = checkpointHeader(CHECKPOINT_KIND_DELTA, count, _gen + 1);
+    bool ok = f.write((const uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr);
+    for (uint16_t b = 0; ok && b < CHECKPOINT_BLOCKS; b++) {
+        if (!_simulator.isBlockDirty(b)) continue;
+        uint16_t first = b * CHECKPOINT_BLOCK_NODES;
+        uint16_t last = first + CHECKPOINT_BLOCK_NODES;
+        if (last > NUM_SIMULATED_NODES) last = NUM_SIMULATED_NODES;   // último bloco incompleto
+        for (uint16_t slot = first; ok && slot < last; slot++) {
+            NodeCheckpoint rec = _pack(_simulator.getNode(slot));
+            ok = f.write((const uint8_t*)&rec, sizeof(rec)) == sizeof(rec);
+        }
+    }
+    f.close();
+
+    if (!ok) {
+        // Blocos continuam sujos: entram no próximo delta
+        LittleFS.remove(CHECKPOINT_DELTA_TMP_PATH);
+        DEBUG_PRINTLN("[CKPT] ERRO: falha ao gravar delta");
+        return false;
+    }
+
+    char path[24];
+    _deltaPath(_gen + 1, path, sizeof(path));
+    if (LittleFS.exists(path)) LittleFS.remove(path);
+    LittleFS.rename(CHECKPOINT_DELTA_TMP_PATH, path);
+
+    _gen++;
+    _deltas++;
+    _blocksWritten += dirtyBlocks;
+    _bytesWritten += sizeof(hdr) + count * sizeof(NodeCheckpoint);
+    _simulator.clearDirty();
+    DEBUG_PRINTF("[CKPT] Delta %lu: %d de %d blocos (%d nós) | cadeia %d\n",
+                 (unsigned long)_gen, dirtyBlocks, CHECKPOINT_BLOCKS, count, getChainLength());
+    return true;
+}
+
+bool AgriNodeCheckpoint::_loadFile(const char* path, uint8_t kind, uint32_t& gen) {
+    if (!LittleFS.exists(path)) return false;
+    File f = LittleFS.open(path, "r");
+    if (!f) return false;
+
+    CheckpointHeader hdr;
+    bool ok = f.read((uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+              hdr.magic == CHECKPOINT_MAGIC &&
+              hdr.version == CHECKPOINT_VERSION &&
+              hdr.kind == kind &&
+              hdr.check == checkpointFnv(&hdr, offsetof(CheckpointHeader, check)) &&
+              (kind != CHECKPOINT_KIND_BASE || hdr.count == NUM_SIMULATED_NODES);
+
+    // Primeiro valida tudo; só então aplica (arquivo ruim não deixa estado pela metade)
+    NodeCheckpoint rec;
+    for (uint16_t i = 0; ok && i < hdr.count; i++) {
+        ok = f.read((uint8_t*)&rec, sizeof(rec)) == sizeof(rec) &&
+             rec.check == _check(rec) &&
+             rec.nodeId >= NODE_ID_BASE && rec.nodeId < NODE_ID_BASE + NUM_SIMULATED_NODES &&
+             (kind != CHECKPOINT_KIND_BASE || rec.nodeId == NODE_ID_BASE + i);
+    }
+    if (ok) {
+        f.seek(sizeof(hdr));
+        for (uint16_t i = 0; i < hdr.count; i++) {
+            f.read((uint8_t*)&rec, sizeof(rec));
+            _restore(rec);
+        }
+        gen = hdr.gen;
+    } else {
+        DEBUG_PRINTF("[CKPT] %s inválido; ignorado\n", path);
+    }
+    f.close();
+    return ok;
+}
+
+void AgriNodeCheckpoint::_removeDeltas(uint32_t fromGen, int8_t direction) {
+    char path[24];
+    for (uint32_t g = fromGen; g > 0; g += direction) {
+        _deltaPath(g, path, sizeof(path));
+        if (!LittleFS.exists(path)) break;
+        LittleFS.remove(path);
+    }
+}
+
+bool AgriNodeCheckpoint::_mergeBegin() {
+    _mergeUpTo = _gen;
+    _mergePos = 0;
+    _mergeOk = false;
+
+    _mergeIn = LittleFS.open(CHECKPOINT_BASE_PATH, "r");
+    _mergeOut = LittleFS.open(CHECKPOINT_BASE_TMP_PATH, "w");
+    if (!_mergeIn || !_mergeOut) {
+        if (_mergeIn) _mergeIn.close();
+        if (_mergeOut) _mergeOut.close();
+        return false;
+    }
+
+    // Cabeçalho com a geração antiga até o fim: se a base sumir no meio, esta
+    // cópia parcialmente aplicada + os mesmos deltas dá o mesmo estado
+    CheckpointHeader hdr;
+    _mergeOk = _mergeIn.read((uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+               _mergeOut.write((const uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr);
+    if (!_mergeOk) {
+        _mergeIn.close();
+        _mergeOut.close();
+    }
+    DEBUG_PRINTF("[CKPT] Fundindo %d deltas na base\n", getChainLength());
+    return true;
+}
+
+void AgriNodeCheckpoint::_mergeCopyStep() {
+    NodeCheckpoint chunk[CHECKPOINT_MERGE_CHUNK];
+    uint16_t n = NUM_SIMULATED_NODES - _mergePos;
+    if (n > CHECKPOINT_MERGE_CHUNK) n = CHECKPOINT_MERGE_CHUNK;
+    size_t bytes = n * sizeof(NodeCheckpoint);
+
+    _mergeOk = _mergeIn.read((uint8_t*)chunk, bytes) == bytes &&
+               _mergeOut.write((const uint8_t*)chunk, bytes) == bytes;
+    _mergePos += n;
+
+    if (!_mergeOk || _mergePos >= NUM_SIMULATED_NODES) {
+        _mergeIn.close();
+        _mergeOut.close();
+    }
+}
+
+void AgriNodeCheckpoint::_mergeApply(uint32_t gen) {
+    char path[24];
+    _deltaPath(gen, path, sizeof(path));
+    File delta = LittleFS.open(path, "r");
+    File base = LittleFS.open(CHECKPOINT_BASE_TMP_PATH, "r+");
+
+    CheckpointHeader hdr;
+    _mergeOk = delta && base &&
+               delta.read((uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+               hdr.magic == CHECKPOINT_MAGIC && hdr.kind == CHECKPOINT_KIND_DELTA && hdr.gen == gen;
+
+    // Registros completos e idempotentes: reaplicar após uma queda não muda o resultado
+    NodeCheckpoint rec;
+    for (uint16_t i = 0; _mergeOk && i < hdr.count; i++) {
+        _mergeOk = delta.read((uint8_t*)&rec, sizeof(rec)) == sizeof(rec) &&
+                   rec.check == _check(rec) &&
+                   rec.nodeId >= NODE_ID_BASE && rec.nodeId < NODE_ID_BASE + NUM_SIMULATED_NODES &&
+                   base.seek(sizeof(hdr) + (rec.nodeId - NODE_ID_BASE) * sizeof(rec)) &&
+                   base.write((const uint8_t*)&rec, sizeof(rec)) == sizeof(rec);
+    }
+
+    if (delta) delta.close();
+    if (base) base.close();
+}
+
+void AgriNodeCheckpoint::_mergeFinish() {
+    if (_mergeOk) {
+        File f = LittleFS.open(CHECKPOINT_BASE_TMP_PATH, "r+");
+        CheckpointHeader hdr = checkpointHeader(CHECKPOINT_KIND_BASE, NUM_SIMULATED_NODES, _mergeUpTo);
+        _mergeOk = f && f.write((const uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr);
+        if (f) f.close();
+    }
+    if (!_mergeOk) {
+        // A cadeia continua válida; nova tentativa no próximo intervalo
+        LittleFS.remove(CHECKPOINT_BASE_TMP_PATH);
+        DEBUG_PRINTLN("[CKPT] ERRO: fusão abortada; cadeia mantida");
+        return;
+    }
+
+    LittleFS.remove(CHECKPOINT_BASE_PATH);
+    LittleFS.rename(CHECKPOINT_BASE_TMP_PATH, CHECKPOINT_BASE_PATH);
+    _baseGen = _mergeUpTo;
+    _removeDeltas(_baseGen, -1);
+    _merges++;
+    DEBUG_PRINTF("[CKPT] Fusão concluída: base na geração %lu | cadeia %d\n",
+                 (unsigned long)_baseGen, getChainLength());
+}
+
+void AgriNodeCheckpoint::_restore(const NodeCheckpoint& record) {
+    AgriculturalNode* node = _simulator.getNodeById(record.nodeId);
+    if (node == nullptr) return;
+    node->cropType = (CropType)record.cropType;
+    node->irrigationStatus = (IrrigationStatus)record.irrigationStatus;
+    node->soilMoisture = record.soilMoisture;
+    node->ambientTemp = record.ambientTemp;
+    node->humidity = record.humidity;
+    // O delta pode ter até um intervalo de atraso: salta os números que o
+    // receptor talvez já tenha visto em vez de reenviá-los como duplicatas
+    node->sequenceNumber = record.sequenceNumber + CHECKPOINT_SEQ_ADVANCE;
+    node->txCount = record.txCount;
+    node->posX = record.posX;
+    node->posY = record.posY;
+}
+
+NodeCheckpoint AgriNodeCheckpoint::_pack(const AgriculturalNode& node) {
+    NodeCheckpoint rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.nodeId = node.nodeId;
+    rec.cropType = node.cropType;
+    rec.irrigationStatus = node.irrigationStatus;
+    rec.soilMoisture = node.soilMoisture;
+    rec.ambientTemp = node.ambientTemp;
+    rec.humidity = node.humidity;
+    rec.sequenceNumber = node.sequenceNumber;
+    rec.txCount = node.txCount;
+    rec.posX = node.posX;
+    rec.posY = node.posY;
+    rec.check = _check(rec);
+    return rec;
+}
+
+uint32_t AgriNodeCheckpoint::_check(const NodeCheckpoint& record) {
+    return checkpointFnv(&record, offsetof(NodeCheckpoint, check));
+}
+
+void AgriNodeCheckpoint::_removeStaleDeltas() {
+    // Varre o diretório em vez de seguir gerações: a cadeia de um boot antigo
+    // pode ter buracos e os arquivos após o buraco escapariam de _removeDeltas.
+    // Reabre a listagem a cada remoção para não apagar durante a iteração.
+    const char* prefix = CHECKPOINT_DELTA_PREFIX + 1;   // name() vem sem a '/'
+    const size_t prefixLen = strlen(prefix);
+    char path[24];
+    bool removed = true;
+    while (removed) {
+        removed = false;
+        File dir = LittleFS.open("/");
+        if (!dir || !dir.isDirectory()) return;
+        File f;
+        while (!removed && (f = dir.openNextFile())) {
+            const char* name = f.name();
+            if (name[0] == '/') name++;
+            if (!f.isDirectory() && strncmp(name, prefix, prefixLen) == 0 &&
+                isdigit((unsigned char)name[prefixLen])) {
+                char* end;
+                unsigned long gen = strtoul(name + prefixLen, &end, 10);
+                // Só "/ckpt.<n>": base e temporários também começam com o prefixo
+                if (*end == '\0' && (!_hasBase || gen <= _baseGen || gen > _gen)) {
+                    snprintf(path, sizeof(path), "/%s", name);
+                    removed = true;
+                }
+            }
+            f.close();
+        }
+        dir.close();
+        if (removed) LittleFS.remove(path);
+    }
+}
+
+void AgriNodeCheckpoint::_deltaPath(uint32_t gen, char* path, size_t size) {
+    snprintf(path, size, "%s%lu", CHECKPOINT_DELTA_PREFIX, (unsigned long)gen);
+}
+
+void AgriNodeCheckpoint::getStatistics(uint32_t& deltas, uint32_t& blocks, uint32_t& bytes, uint32_t& merges) {
+    deltas = _deltas;
+    blocks = _blocksWritten;
+    bytes = _bytesWritten;
+    merges = _merges;
+}
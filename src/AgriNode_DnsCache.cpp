@@ -0,0 +1,175 @@
+/**
+ * @file AgriNode_DnsCache.cpp
+ * @brief Resolução com TTL, renovação antecipada e fallback para IP conhecido
+ */
+#include "AgriNode_DnsCache.h"
+#include <WiFi.h>
+#include <lwip/dns.h>
+
+// DnsLookup::state
+enum : uint8_t {
+    LOOKUP_IDLE = 0,
+    LOOKUP_PENDING,
+    LOOKUP_DONE,
+    LOOKUP_FAILED
+};
+
+// Roda na task do tcpip: só grava o resultado; quem consome é _harvest()
+static void onDnsFound(const char* name, const ip_addr_t* addr, void* arg) {
+    DnsLookup* lookup = (DnsLookup*)arg;
+    if (addr != nullptr && IP_IS_V4(addr)) {
+        lookup->ip = ip4_addr_get_u32(ip_2_ip4(addr));
+        lookup->state = LOOKUP_DONE;
+    } else {
+        lookup->state = LOOKUP_FAILED;
+    }
+}
+
+AgriNodeDnsCache::AgriNodeDnsCache() :
+    _entries(),
+    _hits(0),
+    _misses(0),
+    _staleServed(0)
+{
+}
+
+AgriNodeDnsCache::DnsEntry* AgriNodeDnsCache::_find(const char* host) {
+    for (auto& e : _entries) {
+        if (e.used && strcmp(e.host, host) == 0) return &e;
+    }
+    return nullptr;
+}
+
+AgriNodeDnsCache::DnsEntry* AgriNodeDnsCache::_allocate(const char* host) {
+    if (strlen(host) >= DNS_CACHE_HOST_MAX) return nullptr;
+
+    // Slot livre ou, na falta, a entrada resolvida há mais tempo. Entradas com
+    // consulta em andamento ficam: o callback do lwIP ainda aponta para elas
+    DnsEntry* victim = nullptr;
+    for (auto& e : _entries) {
+        if (!e.used) { victim = &e; break; }
+        if (e.lookup.state == LOOKUP_PENDING) continue;
+        if (victim == nullptr || (long)(e.resolvedAt - victim->resolvedAt) < 0) victim = &e;
+    }
+    if (victim == nullptr) return nullptr;
+
+    memset(victim, 0, sizeof(*victim));
+    strncpy(victim->host, host, DNS_CACHE_HOST_MAX - 1);
+    victim->used = true;
+    return victim;
+}
+
+void AgriNodeDnsCache::_startLookup(DnsEntry& entry, unsigned long now) {
+    ip_addr_t addr;
+    entry.lookup.startedAt = now;
+    entry.lookup.state = LOOKUP_PENDING;
+
+    err_t err = dns_gethostbyname_addrtype(entry.host, &addr, onDnsFound, &entry.lookup,
+                                           LWIP_DNS_ADDRTYPE_IPV4);
+    if (err == ERR_OK) {
+        // Já estava no cache do próprio lwIP: sem callback
+        entry.lookup.ip = ip4_addr_get_u32(ip_2_ip4(&addr));
+        entry.lookup.state = LOOKUP_DONE;
+    } else if (err != ERR_INPROGRESS) {
+        entry.lookup.state = LOOKUP_FAILED;
+    }
+}
+
+DnsResult AgriNodeDnsCache::_harvest(DnsEntry& entry, unsigned long now) {
+    switch (entry.lookup.state) {
+        case LOOKUP_PENDING:
+            if (now - entry.lookup.startedAt < DNS_CACHE_LOOKUP_TIMEOUT_MS) return DNS_PENDING;
+            // Sem resposta: falha para quem pediu, mas a entrada continua PENDING até o
+            // lwIP chamar o callback (ele sempre chama, nem que seja com erro)
+            DEBUG_PRINTF("[DNS] Tempo esgotado resolvendo %s\n", entry.host);
+            return DNS_FAILED;
+
+        case LOOKUP_DONE:
+            entry.lookup.state = LOOKUP_IDLE;
+            if (entry.lookup.ip == 0) return DNS_FAILED;
+            entry.ip = entry.lookup.ip;
+            entry.resolvedAt = now;
+            entry.valid = true;
+            DEBUG_PRINTF("[DNS] %s -> %s (%lu ms)\n", entry.host,
+                         IPAddress(entry.ip).toString().c_str(), now - entry.lookup.startedAt);
+            return DNS_RESOLVED;
+
+        case LOOKUP_FAILED:
+            entry.lookup.state = LOOKUP_IDLE;
+            DEBUG_PRINTF("[DNS] Falha ao resolver %s\n", entry.host);
+            return DNS_FAILED;
+
+        default:
+            return DNS_FAILED;
+    }
+}
+
+DnsResult AgriNodeDnsCache::resolve(const char* host, IPAddress& ip) {
+    DnsEntry* e = _find(host);
+    unsigned long now = millis();
+
+    // Consulta já em andamento (deste pedido ou de refreshExpiring()): colhe o resultado
+    bool harvested = false;
+    DnsResult r = DNS_FAILED;
+    if (e != nullptr && e->lookup.state != LOOKUP_IDLE) {
+        r = _harvest(*e, now);
+        harvested = true;
+    }
+
+    if (e != nullptr && e->valid && now - e->resolvedAt < DNS_CACHE_TTL_MS) {
+        _hits++;
+        ip = IPAddress(e->ip);
+        return DNS_RESOLVED;
+    }
+    if (r == DNS_PENDING) return DNS_PENDING;
+
+    if (!harvested) {
+        if (e == nullptr) e = _allocate(host);
+        if (e == nullptr) return DNS_FAILED;
+        _misses++;
+        _startLookup(*e, now);
+        r = _harvest(*e, now);
+        if (r == DNS_PENDING) return DNS_PENDING;
+    }
+
+    if (r == DNS_RESOLVED) {
+        ip = IPAddress(e->ip);
+        return DNS_RESOLVED;
+    }
+
+    // Resolvedor instável: usa o último endereço conhecido por um tempo limitado
+    if (e->valid && now - e->resolvedAt < DNS_CACHE_STALE_MAX_MS) {
+        _staleServed++;
+        ip = IPAddress(e->ip);
+        DEBUG_PRINTF("[DNS] Usando IP antigo para %s\n", host);
+        return DNS_RESOLVED;
+    }
+    return DNS_FAILED;
+}
+
+void AgriNodeDnsCache::refreshExpiring() {
+    unsigned long now = millis();
+    for (auto& e : _entries) {
+        if (!e.used || !e.valid) continue;
+        if (e.lookup.state != LOOKUP_IDLE) {
+            _harvest(e, now);
+            continue;
+        }
+        if (now - e.resolvedAt >= DNS_CACHE_TTL_MS - DNS_CACHE_REFRESH_AHEAD_MS) {
+            // Só dispara: a resposta é colhida no próximo resolve()/refreshExpiring()
+            _startLookup(e, now);
+            return;
+        }
+    }
+}
+
+void AgriNodeDnsCache::invalidate(const char* host) {
+    DnsEntry* e = _find(host);
+    if (e != nullptr) e->valid = false;
+}
+
+void AgriNodeDnsCache::getStatistics(uint32_t& hits, uint32_t& misses, uint32_t& staleServed) {
+    hits = _hits;
+    misses = _misses;
+    staleServed = _staleServed;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file AgriNode_Ds18b20.cpp
+ * @brief Leitura DS18B20 sem delay(800): conversão disparada e coletada pelo agendador
+ */
+#include "AgriNode_Ds18b20.h"
+
+// Passo de quantização por resolução: 9 bits = 0.5 °C ... 12 bits = 0.0625 °C
+static float resolutionStep(uint8_t bits) {
+    return 0.5f / (float)(1 << (bits - 9));
+}
+
+AgriNodeDs18b20::AgriNodeDs18b20(DallasTemperature& bus, uint8_t index, uint8_t sensorId) :
+    _sensor(bus),
+    _index(index),
+    _sensorId(sensorId),
+    _address(),
+    _parasite(false),
+    _convStartedAt(0),
+    _resolution(DS18B20_MAX_RESOLUTION),
+    _lastTemp(NAN),
+    _hasLast(false)
+{
+}
+
+bool AgriNodeDs18b20::begin() {
+    // _sensor.begin() (busca no barramento) é feito uma vez por quem possui o barramento
+    if (!_sensor.getAddress(_address, _index)) {
+        DEBUG_PRINTF("[DS18B20] Sensor #%d não encontrado no barramento\n", _index);
+        return false;
+    }
+
+    // Conversão assíncrona: requestTemperatures*() retorna na hora
+    _sensor.setWaitForConversion(false);
+    // Resolução só no scratchpad: sem COPY SCRATCHPAD (EEPROM + delay) a cada ajuste
+    _sensor.setAutoSaveScratchPad(false);
+    _sensor.setResolution(_address, _resolution);
+    _parasite = _sensor.isParasitePowerMode();
+    DEBUG_PRINTF("[DS18B20] #%d inicializado (%d bits%s)\n", _index, _resolution,
+                 _parasite ? ", parasita" : "");
+    return true;
+}
+
+unsigned long AgriNodeDs18b20::conversionMs() const {
+    return (unsigned long)_sensor.millisToWaitForConversion(_resolution);
+}
+
+bool AgriNodeDs18b20::start(unsigned long now) {
+    _sensor.requestTemperaturesByAddress(_address);
+    _convStartedAt = now;
+    return true;
+}
+
+SensorPoll AgriNodeDs18b20::poll(unsigned long now) {
+    // Só temporizador: consultar o barramento não é possível em modo parasita
+    return (now - _convStartedAt >= conversionMs()) ? SENSOR_READY : SENSOR_BUSY;
+}
+
+uint8_t AgriNodeDs18b20::read(SensorReading* out, uint8_t maxReadings, unsigned long now) {
+    if (maxReadings == 0) return 0;
+
+    float t = _sensor.getTempC(_address);
+    if (t == DEVICE_DISCONNECTED_C || t < -50.0 || t > 125.0) {
+        DEBUG_PRINTLN("[DS18B20] Leitura inválida");
+        return 0;
+    }
+
+    float delta = _hasLast ? fabsf(t - _lastTemp) : 0.0f;
+    _lastTemp = t;
+    _hasLast = true;
+    DEBUG_PRINTF("[DS18B20] Temperatura: %.2f °C (%d bits, %lu ms)\n", t, _resolution, conversionMs());
+
+    _adaptResolution(delta);
+
+    out[0].sensorId = _sensorId;
+    out[0].kind = SENSOR_TEMPERATURE;
+    out[0].value = t;
+    out[0].takenAt = now;
+    return 1;
+}
+
+void AgriNodeDs18b20::_adaptResolution(float delta) {
+    // Variação grande entre ciclos: a defasagem da leitura pesa mais que a
+    // quantização, então uma conversão curta basta. Estável: mais bits para
+    // que pequenas variações apareçam. O uplink usa 2 casas decimais, mas o
+    // sensor não passa de 0.0625 °C, portanto 12 bits é o teto útil.
+    float wantedStep = delta / DS18B20_STEPS_PER_DELTA;
+
+    uint8_t bits = DS18B20_MAX_RESOLUTION;
+    while (bits > DS18B20_MIN_RESOLUTION && resolutionStep(bits - 1) <= wantedStep) {
+        bits--;
+    }
+
+    // Sobe imediatamente; desce um bit por ciclo (evita oscilar com ruído)
+    if (bits < _resolution - 1) bits = _resolution - 1;
+
+    if (bits != _resolution) {
+        DEBUG_PRINTF("[DS18B20] Resolução %d -> %d bits (Δ=%.2f °C)\n", _resolution, bits, delta);
+        _resolution = bits;
+        _sensor.setResolution(_address, _resolution);
+    }
+}
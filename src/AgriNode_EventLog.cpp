@@ -0,0 +1,247 @@
+/**
+ * @file AgriNode_EventLog.cpp
+ * @brief Log de eventos em LittleFS: anexação, compactação em snapshot e replay
+ */
+#include "AgriNode_EventLog.h"
+#include <LittleFS.h>
+#include <time.h>
+
+#define EVENT_SNAPSHOT_MAGIC    0xE5A9501DUL
+#define EVENT_SNAPSHOT_VERSION  1
+
+struct EventSnapshotHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t nodeCount;
+    uint32_t lastSeq;         // último evento incorporado
+    uint32_t checksum;        // FNV-1a dos estados
+};
+
+static uint32_t eventChecksum(const uint8_t* p, size_t len) {
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < len; i++) h = (h ^ p[i]) * 16777619UL;
+    return h;
+}
+
+AgriNodeEventLog::AgriNodeEventLog() :
+    _ready(false),
+    _seq(0),
+    _snapshotSeq(0),
+    _logBytes(0),
+    _logged(0),
+    _replayed(0),
+    _compactions(0),
+    _torn(false),
+    _states()
+{
+}
+
+bool AgriNodeEventLog::begin() {
+    if (!LittleFS.begin(true)) {
+        DEBUG_PRINTLN("[EVENTOS] ERRO: LittleFS indisponível; log desativado");
+        return false;
+    }
+
+    // Snapshot temporário só sobra se a queda foi entre apagar o antigo e renomear
+    if (!_loadSnapshot(EVENT_SNAPSHOT_PATH)) _loadSnapshot(EVENT_SNAPSHOT_TMP_PATH);
+    _seq = _snapshotSeq;
+    _replayLog();
+
+    _ready = true;
+    DEBUG_PRINTF("[EVENTOS] Snapshot até seq %lu + %lu eventos do log (%lu bytes)\n",
+                 (unsigned long)_snapshotSeq, (unsigned long)_replayed, (unsigned long)_logBytes);
+    // Cauda cortada: anexar depois dela desalinharia todo evento seguinte
+    if (_torn) compact();
+    return true;
+}
+
+bool AgriNodeEventLog::_loadSnapshot(const char* path) {
+    if (!LittleFS.exists(path)) return false;
+    File f = LittleFS.open(path, "r");
+    if (!f) return false;
+
+    EventSnapshotHeader hdr;
+    NodeEventState states[NUM_SIMULATED_NODES];
+    bool ok = f.read((uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+              hdr.magic == EVENT_SNAPSHOT_MAGIC &&
+              hdr.version == EVENT_SNAPSHOT_VERSION &&
+              hdr.nodeCount == NUM_SIMULATED_NODES &&
+              f.read((uint8_t*)states, sizeof(states)) == sizeof(states) &&
+              hdr.checksum == eventChecksum((const uint8_t*)states, sizeof(states));
+    f.close();
+
+    if (!ok) {
+        DEBUG_PRINTF("[EVENTOS] Snapshot %s inválido; ignorado\n", path);
+        return false;
+    }
+    memcpy(_states, states, sizeof(_states));
+    _snapshotSeq = hdr.lastSeq;
+    return true;
+}
+
+void AgriNodeEventLog::_replayLog() {
+    _logBytes = 0;
+    _replayed = 0;
+    if (!LittleFS.exists(EVENT_LOG_PATH)) return;
+    File f = LittleFS.open(EVENT_LOG_PATH, "r");
+    if (!f) return;
+
+    NodeEvent ev;
+    while (f.read((uint8_t*)&ev, sizeof(ev)) == sizeof(ev)) {
+        // Cauda cortada no meio de uma escrita: para aqui; begin() compacta e a descarta
+        if (ev.crc != _crc16(ev)) break;
+        _logBytes += sizeof(ev);
+        if ((int32_t)(ev.seq - _snapshotSeq) <= 0) continue;   // já no snapshot
+        _apply(ev);
+        _replayed++;
+        if ((int32_t)(ev.seq - _seq) > 0) _seq = ev.seq;
+    }
+    _torn = f.size() > _logBytes;
+    f.close();
+}
+
+bool AgriNodeEventLog::record(uint16_t nodeId, int8_t oldState, int8_t newState, float trigger) {
+    if (!_ready) return false;
+
+    time_t now;
+    time(&now);
+
+    NodeEvent ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.seq = _seq + 1;
+    ev.epoch = ((unsigned long)now >= TIME_VALID_EPOCH_MIN) ? (uint32_t)now : 0;
+    ev.uptimeMs = millis();
+    ev.trigger = trigger;
+    ev.nodeId = nodeId;
+    ev.kind = EVENT_IRRIGATION;
+    ev.oldState = oldState;
+    ev.newState = newState;
+    ev.crc = _crc16(ev);
+
+    // Sem truncate no File: a cauda parcial só sai zerando o log na compactação
+    if (_torn && !compact()) return false;
+
+    File f = LittleFS.open(EVENT_LOG_PATH, "a");
+    if (!f) return false;
+    size_t written = f.write((const uint8_t*)&ev, sizeof(ev));
+    f.close();
+    if (written != sizeof(ev)) {
+        DEBUG_PRINTF("[EVENTOS] ERRO: falha ao anexar evento (%u de %u bytes)\n",
+                     (unsigned)written, (unsigned)sizeof(ev));
+        if (written > 0) {
+            _torn = true;
+            compact();    // o evento perdido não entra no estado; o snapshot também não
+        }
+        return false;
+    }
+
+    _seq = ev.seq;
+    _logBytes += sizeof(ev);
+    _logged++;
+    _apply(ev);
+
+    if (_logBytes >= EVENT_LOG_COMPACT_BYTES) compact();
+    return true;
+}
+
+bool AgriNodeEventLog::compact() {
+    if (!_ready) return false;
+
+    EventSnapshotHeader hdr;
+    hdr.magic = EVENT_SNAPSHOT_MAGIC;
+    hdr.version = EVENT_SNAPSHOT_VERSION;
+    hdr.nodeCount = NUM_SIMULATED_NODES;
+    hdr.lastSeq = _seq;
+    hdr.checksum = eventChecksum((const uint8_t*)_states, sizeof(_states));
+
+    File f = LittleFS.open(EVENT_SNAPSHOT_TMP_PATH, "w");
+    if (!f) return false;
+    bool ok = f.write((const uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+              f.write((const uint8_t*)_states, sizeof(_states)) == sizeof(_states);
+    f.close();
+    if (!ok) {
+        LittleFS.remove(EVENT_SNAPSHOT_TMP_PATH);
+        DEBUG_PRINTLN("[EVENTOS] ERRO: falha ao gravar snapshot; log mantido");
+        return false;
+    }
+
+    // Ordem segura: o log só some depois que o snapshot novo está no lugar
+    // (eventos repetidos no log são ignorados pelo seq)
+    LittleFS.remove(EVENT_SNAPSHOT_PATH);
+    LittleFS.rename(EVENT_SNAPSHOT_TMP_PATH, EVENT_SNAPSHOT_PATH);
+    LittleFS.remove(EVENT_LOG_PATH);
+
+    _snapshotSeq = _seq;
+    _logBytes = 0;
+    _torn = false;
+    _compactions++;
+    DEBUG_PRINTF("[EVENTOS] Log compactado no snapshot (seq %lu)\n", (unsigned long)_seq);
+    return true;
+}
+
+uint32_t AgriNodeEventLog::replay(uint32_t sinceSeq, NodeEventCallback callback, void* context) {
+    if (!_ready || callback == nullptr || !LittleFS.exists(EVENT_LOG_PATH)) return 0;
+    File f = LittleFS.open(EVENT_LOG_PATH, "r");
+    if (!f) return 0;
+
+    uint32_t delivered = 0;
+    NodeEvent ev;
+    while (f.read((uint8_t*)&ev, sizeof(ev)) == sizeof(ev)) {
+        if (ev.crc != _crc16(ev)) break;
+        if ((int32_t)(ev.seq - sinceSeq) <= 0) continue;
+        callback(ev, context);
+        delivered++;
+    }
+    f.close();
+    return delivered;
+}
+
+void AgriNodeEventLog::_apply(const NodeEvent& event) {
+    if (event.nodeId < NODE_ID_BASE || event.nodeId >= NODE_ID_BASE + NUM_SIMULATED_NODES) return;
+    NodeEventState& st = _states[event.nodeId - NODE_ID_BASE];
+    st.nodeId = event.nodeId;
+    st.state = event.newState;
+    st.lastEpoch = event.epoch;
+    st.lastTrigger = event.trigger;
+    st.transitions++;
+}
+
+const NodeEventState* AgriNodeEventLog::getNodeState(uint16_t nodeId) const {
+    if (nodeId < NODE_ID_BASE || nodeId >= NODE_ID_BASE + NUM_SIMULATED_NODES) return nullptr;
+    const NodeEventState& st = _states[nodeId - NODE_ID_BASE];
+    return st.nodeId != 0 ? &st : nullptr;
+}
+
+uint16_t AgriNodeEventLog::_crc16(const NodeEvent& event) {
+    // CRC-16/CCITT-FALSE, como o ReadingStore: o XOR de um byte deixava passar
+    // um em 256 registros corrompidos
+    const uint8_t* p = (const uint8_t*)&event;
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < offsetof(NodeEvent, crc); i++) {
+        crc ^= (uint16_t)p[i] << 8;
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+void AgriNodeEventLog::printRecoveredState() {
+    DEBUG_PRINTLN("[EVENTOS] Estado recuperado (snapshot + log):");
+    uint8_t shown = 0;
+    for (uint8_t i = 0; i < NUM_SIMULATED_NODES; i++) {
+        const NodeEventState& st = _states[i];
+        if (st.nodeId == 0) continue;
+        DEBUG_PRINTF("  Nó %d: irrigação %d | %lu transições | umidade %.1f%% | epoch %lu\n",
+                     st.nodeId, st.state, (unsigned long)st.transitions, st.lastTrigger,
+                     (unsigned long)st.lastEpoch);
+        shown++;
+    }
+    if (shown == 0) DEBUG_PRINTLN("  (nenhum evento registrado)");
+}
+
+void AgriNodeEventLog::getStatistics(uint32_t& logged, uint32_t& logBytes, uint32_t& compactions) {
+    logged = _logged;
+    logBytes = _logBytes;
+    compactions = _compactions;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file AgriNode_History.cpp
+ * @brief Codificador de bits do histórico: prefixos de tamanho variável para tempo, valores e status
+ */
+#include "AgriNode_History.h"
+#include <math.h>
+#include <string.h>
+
+// Leitura completa no início de cada bloco: tempo + 3 valores + status
+#define HISTORY_FULL_BITS  (32 + 3 * 16 + 2)
+
+// Prefixo '0', '10', '110', '1110', '1111' escolhe a largura do campo seguinte
+static const uint8_t timeBits[5]  = {0, 7, 9, 12, 32};   // delta-of-delta (com sinal)
+static const uint8_t valueBits[5] = {0, 4, 6, 9, 16};    // delta com sinal; 16 = valor absoluto
+
+static uint8_t bucketFor(int32_t v, const uint8_t* widths) {
+    if (v == 0) return 0;
+    for (uint8_t b = 1; b < 4; b++) {
+        int32_t limit = 1L << (widths[b] - 1);
+        if (v >= -limit && v < limit) return b;
+    }
+    return 4;
+}
+
+static inline uint8_t prefixBits(uint8_t bucket) {
+    return bucket < 4 ? bucket + 1 : 4;
+}
+
+static inline int32_t signExtend(uint32_t v, uint8_t bits) {
+    if (bits >= 32) return (int32_t)v;
+    uint32_t m = 1UL << (bits - 1);
+    return (int32_t)((v ^ m) - m);
+}
+
+AgriNodeHistory::AgriNodeHistory() :
+    _blocks(),
+    _head(0),
+    _used(0),
+    _last(),
+    _dropped(0)
+{
+}
+
+void AgriNodeHistory::clear() {
+    _head = 0;
+    _used = 0;
+    _dropped = 0;
+}
+
+int16_t AgriNodeHistory::_quantize(float value) {
+    float q = floorf(value * HISTORY_SCALE + 0.5f);
+    if (q > 32767.0f) return 32767;
+    if (q < -32768.0f) return -32768;
+    return (int16_t)q;
+}
+
+void AgriNodeHistory::append(const HistoryReading& reading) {
+    Codec next;
+    next.time = reading.time;
+    next.delta = 0;
+    next.value[0] = _quantize(reading.soilMoisture);
+    next.value[1] = _quantize(reading.ambientTemp);
+    next.value[2] = _quantize(reading.humidity);
+    next.status = reading.irrigationStatus;
+
+    bool startBlock = (_used == 0);
+    if (!startBlock && _blocks[_head].bits + _encodedBits(_last, next) > HISTORY_BLOCK_BYTES * 8) {
+        _head = (_head + 1) % HISTORY_BLOCKS;
+        if (_used == HISTORY_BLOCKS) {
+            _dropped += _blocks[_head].count;     // anel cheio: sai o bloco mais antigo
+        } else {
+            _used++;
+        }
+        startBlock = true;
+    }
+
+    Block& block = _blocks[_head];
+    if (startBlock) {
+        if (_used == 0) _used = 1;
+        memset(block.data, 0, sizeof(block.data));
+        block.bits = 0;
+        block.count = 0;
+        _writeBits(block, next.time, 32);
+        for (uint8_t i = 0; i < 3; i++) _writeBits(block, (uint16_t)next.value[i], 16);
+        _writeBits(block, (uint8_t)next.status & 0x03, 2);
+    } else {
+        _encode(block, _last, next);
+        next.delta = (int32_t)(next.time - _last.time);
+    }
+    block.count++;
+    _last = next;
+}
+
+uint16_t AgriNodeHistory::_encodedBits(const Codec& last, const Codec& next) {
+    int32_t dod = (int32_t)(next.time - last.time) - last.delta;
+    uint8_t b = bucketFor(dod, timeBits);
+    uint16_t bits = prefixBits(b) + timeBits[b];
+
+    for (uint8_t i = 0; i < 3; i++) {
+        b = bucketFor((int32_t)next.value[i] - last.value[i], valueBits);
+        bits += prefixBits(b) + valueBits[b];
+    }
+    bits += (next.status == last.status) ? 1 : 3;
+    return bits;
+}
+
+void AgriNodeHistory::_encode(Block& block, const Codec& last, const Codec& next) {
+    int32_t dod = (int32_t)(next.time - last.time) - last.delta;
+    uint8_t b = bucketFor(dod, timeBits);
+    _writeBits(block, (1UL << prefixBits(b)) - 2 + (b == 4), prefixBits(b));
+    if (b) _writeBits(block, (uint32_t)dod, timeBits[b]);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        int32_t d = (int32_t)next.value[i] - last.value[i];
+        b = bucketFor(d, valueBits);
+        _writeBits(block, (1UL << prefixBits(b)) - 2 + (b == 4), prefixBits(b));
+        if (b == 4) {
+            _writeBits(block, (uint16_t)next.value[i], 16);
+        } else if (b) {
+            _writeBits(block, (uint32_t)d, valueBits[b]);
+        }
+    }
+
+    if (next.status == last.status) {
+        _writeBits(block, 0, 1);
+    } else {
+        _writeBits(block, 0x04 | ((uint8_t)next.status & 0x03), 3);
+    }
+}
+
+void AgriNodeHistory::_decode(const Block& block, uint16_t& pos, Codec& state) {
+    uint8_t b = 0;
+    while (b < 4 && _readBits(block, pos, 1)) b++;
+    int32_t dod = b ? signExtend(_readBits(block, pos, timeBits[b]), timeBits[b]) : 0;
+    state.delta += dod;
+    state.time += (uint32_t)state.delta;
+
+    for (uint8_t i = 0; i < 3; i++) {
+        b = 0;
+        while (b < 4 && _readBits(block, pos, 1)) b++;
+        if (b == 4) {
+            state.value[i] = (int16_t)_readBits(block, pos, 16);
+        } else if (b) {
+            state.value[i] += signExtend(_readBits(block, pos, valueBits[b]), valueBits[b]);
+        }
+    }
+
+    if (_readBits(block, pos, 1)) state.status = (int8_t)_readBits(block, pos, 2);
+}
+
+uint16_t AgriNodeHistory::forEach(HistoryCallback callback, void* context) const {
+    if (callback == nullptr) return 0;
+    uint16_t delivered = 0;
+    HistoryReading r;
+
+    // Bloco mais antigo = o seguinte ao atual quando o anel já deu a volta
+    uint8_t first = (_used == HISTORY_BLOCKS) ? (_head + 1) % HISTORY_BLOCKS : 0;
+    for (uint8_t n = 0; n < _used; n++) {
+        const Block& block = _blocks[(first + n) % HISTORY_BLOCKS];
+        uint16_t pos = 0;
+        Codec state;
+        state.time = _readBits(block, pos, 32);
+        state.delta = 0;
+        for (uint8_t i = 0; i < 3; i++) state.value[i] = (int16_t)_readBits(block, pos, 16);
+        state.status = (int8_t)_readBits(block, pos, 2);
+
+        for (uint16_t k = 0; k < block.count; k++) {
+            if (k > 0) _decode(block, pos, state);
+            r.time = state.time;
+            r.soilMoisture = (float)state.value[0] / HISTORY_SCALE;
+            r.ambientTemp = (float)state.value[1] / HISTORY_SCALE;
+            r.humidity = (float)state.value[2] / HISTORY_SCALE;
+            r.irrigationStatus = state.status;
+            callback(r, context);
+            delivered++;
+        }
+    }
+    return delivered;
+}
+
+uint16_t AgriNodeHistory::size() const {
+    uint16_t total = 0;
+    for (uint8_t i = 0; i < HISTORY_BLOCKS; i++) {
+        if (_used == HISTORY_BLOCKS || i < _used) total += _blocks[i].count;
+    }
+    return total;
+}
+
+uint16_t AgriNodeHistory::bytesUsed() const {
+    uint16_t bits = 0;
+    for (uint8_t i = 0; i < HISTORY_BLOCKS; i++) {
+        if (_used == HISTORY_BLOCKS || i < _used) bits += _blocks[i].bits;
+    }
+    return (bits + 7) / 8;
+}
+
+void AgriNodeHistory::_writeBits(Block& block, uint32_t value, uint8_t bits) {
+    // MSB primeiro, bit a bit: poucos bits por leitura a cada 30 s
+    for (int8_t i = bits - 1; i >= 0; i--) {
+        if ((value >> i) & 1UL) block.data[block.bits >> 3] |= 0x80 >> (block.bits & 7);
+        block.bits++;
+    }
+}
+
+uint32_t AgriNodeHistory::_readBits(const Block& block, uint16_t& pos, uint8_t bits) {
+    uint32_t value = 0;
+    while (bits > 0) {
+        // Bytes inteiros quando alinhado: decodificação sequencial rápida
+        uint8_t offset = pos & 7;
+        uint8_t take = 8 - offset;
+        if (take > bits) take = bits;
+        uint8_t byte = block.data[pos >> 3];
+        uint8_t chunk = (byte >> (8 - offset - take)) & ((1U << take) - 1);
+        value = (value << take) | chunk;
+        pos += take;
+        bits -= take;
+    }
+    return value;
+}
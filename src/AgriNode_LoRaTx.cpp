@@ -5,11 +5,44 @@
 #include "AgriNode_LoRaTx.h"
 #include <SPI.h>
 
-AgriNodeLoRaTx::AgriNodeLoRaTx() :
+// Registradores do SX1276 tratados fora da biblioteca
+#define SX1276_REG_IRQ_FLAGS      0x12
+#define SX1276_REG_DIO_MAPPING_1  0x40
+#define SX1276_IRQ_TX_DONE        0x08
+#define SX1276_DIO0_TX_DONE       0x40
+
+// Sinalizado pela ISR do DIO0 (TxDone) quando o pacote sai do rádio.
+// Não usa LoRa.onTxDone(): a ISR da biblioteca faz SPI (mutex do FreeRTOS)
+// dentro da interrupção; aqui a ISR só marca e a tarefa limpa as flags.
+static volatile bool loraTxDone = false;
+
+static void IRAM_ATTR onLoRaTxDone() {
+    loraTxDone = true;
+}
+
+// Escrita direta em registrador; só no contexto da tarefa, nunca na ISR
+static void loraWriteRegister(uint8_t reg, uint8_t value) {
+    SPI.beginTransaction(SPISettings(8E6, MSBFIRST, SPI_MODE0));
+    digitalWrite(LORA_CS, LOW);
+    SPI.transfer(reg | 0x80);
+    SPI.transfer(value);
+    digitalWrite(LORA_CS, HIGH);
+    SPI.endTransaction();
+}
+
+AgriNodeLoRaTx::AgriNodeLoRaTx(AgriNodeSimulator& simulator) :
+    AgriNodeTask("lora_tx"),
+    _simulator(simulator),
     _initialized(false),
     _lastTxTime(0),
+    _startTime(0),
+    _nextTxAt(0),
     _packetsSent(0),
-    _packetsFailed(0)
+    _packetsFailed(0),
+    _channelBusy(0),
+    _frame(),
+    _lbtSample(0),
+    _txOk(false)
 {
 }
 
@@ -19,6 +52,7 @@ bool AgriNodeLoRaTx::begin() {
     DEBUG_PRINTF("[LoRaTx] Team ID: %d\n", TEAM_ID);
     DEBUG_PRINTLN("========================================");
 
+    _simulator.onAlarm(_onNodeAlarm, this);
     return _initLoRa();
 }
 
@@ -39,8 +73,13 @@ bool AgriNodeLoRaTx::_initLoRa() {
     }
 
     _configureLoRaParameters();
+    // endPacket(true) retorna na hora; o fim do TX chega pelo DIO0 mapeado em TxDone
+    loraWriteRegister(SX1276_REG_DIO_MAPPING_1, SX1276_DIO0_TX_DONE);
+    pinMode(LORA_DIO0, INPUT);
+    attachInterrupt(digitalPinToInterrupt(LORA_DIO0), onLoRaTxDone, RISING);
     DEBUG_PRINTLN("[LoRaTx] Online! Sincronizado com Satélite.");
     _initialized = true;
+    _startTime = millis();
     return true;
 }
 
@@ -59,90 +98,167 @@ void AgriNodeLoRaTx::_configureLoRaParameters() {
     LoRa.disableInvertIQ(); // Ground Nodes não invertem IQ
 }
 
-bool AgriNodeLoRaTx::_isChannelFree() {
-    const int RSSI_THRESHOLD = -90;
-    // CAD simples (verifica RSSI 3 vezes)
-    for (uint8_t i = 0; i < 3; i++) {
-        if (LoRa.rssi() > RSSI_THRESHOLD) {
-            delay(random(50, 200)); // Backoff
-            return false;
+void AgriNodeLoRaTx::_enqueueDueNodes(unsigned long now) {
+    long nextTxIn = TX_INTERVAL_BASE_MS + TX_JITTER_MS;
+
+    for (uint8_t i = 0; i < NUM_SIMULATED_NODES; i++) {
+        AgriculturalNode& node = _simulator.getNode(i);
+        // Slots seguem a ordem de Hilbert (muda a cada boot): jitter fica preso ao ID
+        uint16_t rank = node.nodeId - NODE_ID_BASE;
+        
+        // Intervalo de transmissão com Jitter para evitar colisões
+        uint32_t txInterval = TX_INTERVAL_BASE_MS + (rank * (TX_JITTER_MS / NUM_SIMULATED_NODES));
+        if (txInterval < LORA_MIN_TX_INTERVAL_MS) txInterval = LORA_MIN_TX_INTERVAL_MS;
+
+        unsigned long dueAt;
+        if (node.lastTxTime == 0) {
+            // Primeiro frame deste boot (sem esperar o intervalo base), escalonado por nó;
+            // txCount vem do checkpoint e não serve de marcador por boot
+            dueAt = _startTime + (unsigned long)rank * TX_BOOT_STAGGER_MS;
+        } else {
+            dueAt = node.lastTxTime + txInterval;
+        }
+
+        if ((long)(now - dueAt) >= 0) {
+            // Continua vencido até um TX ter sucesso: cada passada só atualiza
+            // o frame pendente do nó com a leitura mais nova
+            _simulator.refreshIfStale(node, now);
+            _queue.push(_snapshot(node, false, now));
+        } else if ((long)(dueAt - now) < nextTxIn) {
+            nextTxIn = (long)(dueAt - now);
         }
-        delay(10);
     }
-    return true;
+
+    if (!_queue.isEmpty()) nextTxIn = 0;
+    _nextTxAt = now + (unsigned long)nextTxIn;
 }
 
-void AgriNodeLoRaTx::update(AgriNodeSimulator& simulator) {
-    if (!_initialized) return;
+TxFrame AgriNodeLoRaTx::_snapshot(const AgriculturalNode& node, bool alarm, unsigned long now) {
+    TxFrame frame;
+    frame.nodeId = node.nodeId;
+    frame.soilMoisture = node.soilMoisture;
+    frame.ambientTemp = node.ambientTemp;
+    frame.humidity = node.humidity;
+    frame.irrigationStatus = node.irrigationStatus;
+    frame.dataTimestamp = node.dataTimestamp;
+    frame.capturedAt = now;
+    frame.alarm = alarm;
+    return frame;
+}
 
-    unsigned long currentTime = millis();
+void AgriNodeLoRaTx::_onNodeAlarm(const AgriculturalNode& node, void* context) {
+    AgriNodeLoRaTx* self = (AgriNodeLoRaTx*)context;
+    self->_queue.push(_snapshot(node, true, millis()));
+}
 
-    for (uint8_t i = 0; i < NUM_SIMULATED_NODES; i++) {
-        AgriculturalNode& node = simulator.getNode(i);
-        
-        // Intervalo de transmissão com Jitter para evitar colisões
-        uint32_t txInterval = TX_INTERVAL_BASE_MS + (i * (TX_JITTER_MS / NUM_SIMULATED_NODES));
-        if (txInterval < LORA_MIN_TX_INTERVAL_MS) txInterval = LORA_MIN_TX_INTERVAL_MS;
+TaskStatus AgriNodeLoRaTx::run() {
+    TASK_BEGIN();
+    TASK_WAIT_UNTIL(_initialized);
 
-        if (currentTime - node.lastTxTime >= txInterval) {
-            // Verifica canal antes de enviar (LBT - Listen Before Talk)
-            if (!_isChannelFree()) {
-                digitalWrite(LED_ERROR, HIGH);
-                delay(10);
-                digitalWrite(LED_ERROR, LOW);
-                delay(random(100, 500)); // Espera aleatória
-                continue;
-            }
+    while (true) {
+        _enqueueDueNodes(taskNow());
+        if (_queue.isEmpty()) {
+            // Acorda no próximo vencimento ou antes, se um alarme entrar na fila
+            TASK_WAIT_UNTIL_TIMEOUT(!_queue.isEmpty(), _nextTxAt - taskNow());
+            continue;
+        }
 
-            if (_transmitNode(node)) {
-                node.lastTxTime = currentTime;
-                node.sequenceNumber++;
-                node.txCount++;
-                _packetsSent++;
-                _blinkLED(1);
-            } else {
-                _packetsFailed++;
-            }
+        // LBT (Listen Before Talk): 3 amostras de RSSI espaçadas de 10 ms
+        for (_lbtSample = 0; _lbtSample < 3; _lbtSample++) {
+            if (LoRa.rssi() > LORA_LBT_RSSI_THRESHOLD) break;
+            TASK_SLEEP(10);
+        }
+        _recordAttempt(_lbtSample < 3);
+        if (_lbtSample < 3) {
+            // Canal ocupado: a fila segue coalescendo durante a espera aleatória
+            digitalWrite(LED_ERROR, HIGH);
+            TASK_SLEEP(10);
+            digitalWrite(LED_ERROR, LOW);
+            TASK_SLEEP(random(150, 700));
+            continue;
+        }
 
-            delay(100); // Pequeno delay entre nós
+        _queue.pop(_frame);
+        loraTxDone = false;
+        _txOk = _startTransmit(_frame);
+        if (_txOk) {
+            TASK_WAIT_UNTIL_TIMEOUT(loraTxDone, LORA_TX_TIMEOUT_MS);
+            if (taskTimedOut()) {
+                LoRa.idle();              // sem TxDone: tira o rádio do modo TX
+                _txOk = false;
+            }
+            // Baixa o DIO0 para a próxima borda de subida
+            loraWriteRegister(SX1276_REG_IRQ_FLAGS, SX1276_IRQ_TX_DONE);
+        }
+        if (!_txOk) _recordAttempt(true);
+        _finishTransmit(_frame, _txOk, taskNow());
+
+        if (_txOk) {
+            // Sucesso: pulso no LED de TX e piscada do LED de status
+            digitalWrite(LED_TX, HIGH);
+            TASK_SLEEP(50);
+            digitalWrite(LED_TX, LOW);
+            digitalWrite(LED_STATUS, LOW);
+            TASK_SLEEP(50);
+            digitalWrite(LED_STATUS, HIGH);
+        } else {
+            digitalWrite(LED_ERROR, HIGH);
+            TASK_SLEEP(100);
+            digitalWrite(LED_ERROR, LOW);
         }
+
+        TASK_SLEEP(100); // Pequeno intervalo entre nós
     }
+
+    TASK_END();
 }
 
-bool AgriNodeLoRaTx::_transmitNode(AgriculturalNode& node) {
-    std::vector<uint8_t> payload = _createBinaryPayload(node);
+unsigned long AgriNodeLoRaTx::msUntilNextTx() const {
+    if (!_queue.isEmpty()) return 0;
+    long remaining = (long)(_nextTxAt - millis());
+    return remaining > 0 ? (unsigned long)remaining : 0;
+}
+
+bool AgriNodeLoRaTx::_startTransmit(const TxFrame& frame) {
+    std::vector<uint8_t> payload = _createBinaryPayload(frame);
     if (payload.empty()) return false;
 
     DEBUG_PRINTLN("----------------------------------------");
-    DEBUG_PRINTF("[Node %d] TX BINÁRIO (%d bytes) -> Sat\n", node.nodeId, payload.size());
+    DEBUG_PRINTF("[Node %d] TX BINÁRIO%s (%d bytes) -> Sat\n", frame.nodeId,
+                 frame.alarm ? " ALARME" : "", payload.size());
     
     #if ENABLE_NODE_TIMESTAMP
-    DEBUG_PRINTF("  TS: %u | Umid: %.1f | Temp: %.1f\n", node.dataTimestamp, node.soilMoisture, node.ambientTemp);
+    DEBUG_PRINTF("  TS: %u | Umid: %.1f | Temp: %.1f\n", frame.dataTimestamp, frame.soilMoisture, frame.ambientTemp);
     #endif
 
-    LoRa.beginPacket();
+    if (!LoRa.beginPacket()) return false;   // rádio ainda transmitindo
     LoRa.write(payload.data(), payload.size());
-    bool success = LoRa.endPacket(true); // true = async (non-blocking) se possível, mas aqui usamos wait implícito
+    return LoRa.endPacket(true);             // assíncrono: conclusão via onLoRaTxDone()
+}
 
+void AgriNodeLoRaTx::_finishTransmit(const TxFrame& frame, bool success, unsigned long now) {
     if (success) {
-        node.lastRssi = LoRa.packetRssi(); // RSSI do último pacote recebido (se houvesse RX, mas aqui é TX)
+        AgriculturalNode* node = _simulator.getNodeById(frame.nodeId);
+        if (node != nullptr) {
+            node->lastRssi = LoRa.packetRssi(); // RSSI do último pacote recebido (se houvesse RX, mas aqui é TX)
+            node->lastTxTime = now;
+            node->sequenceNumber++;
+            node->txCount++;
+            _simulator.markDirty(*node);
+        }
+        _lastTxTime = now;
+        _packetsSent++;
         DEBUG_PRINTLN("  >> Enviado com SUCESSO");
-
-        digitalWrite(LED_TX, HIGH);
-        delay(50);
-        digitalWrite(LED_TX, LOW);
         digitalWrite(LED_ERROR, LOW);
     } else {
         DEBUG_PRINTLN("  !! FALHA no envio");
-        digitalWrite(LED_ERROR, HIGH);
-        delay(100);
-        digitalWrite(LED_ERROR, LOW);
+        _packetsFailed++;
+        // Volta para a fila; se o nó já tem leitura mais nova pendente, ela vence
+        _queue.push(frame);
     }
-
-    return success;
 }
 
-std::vector<uint8_t> AgriNodeLoRaTx::_createBinaryPayload(const AgriculturalNode& node) {
+std::vector<uint8_t> AgriNodeLoRaTx::_createBinaryPayload(const TxFrame& frame) {
     std::vector<uint8_t> payload;
     // Tamanho estimado: Header(4) + NodeID(2) + Dados(6) + TS(4) = 16 bytes
     payload.reserve(16); 
@@ -157,23 +273,23 @@ std::vector<uint8_t> AgriNodeLoRaTx::_createBinaryPayload(const AgriculturalNode
     // Offset 4 no decoder do Satélite começa aqui:
     
     // Node ID (2 bytes)
-    payload.push_back((node.nodeId >> 8) & 0xFF);
-    payload.push_back(node.nodeId & 0xFF);
+    payload.push_back((frame.nodeId >> 8) & 0xFF);
+    payload.push_back(frame.nodeId & 0xFF);
     
     // Soil Moisture (1 byte, 0-100)
-    payload.push_back((uint8_t)constrain(node.soilMoisture, 0.0, 100.0));
+    payload.push_back((uint8_t)constrain(frame.soilMoisture, 0.0, 100.0));
 
     // Temperature (2 bytes)
     // Encoding: (temp + 50) * 10. Ex: 25.0C -> (75 * 10) = 750
-    int16_t tempEncoded = (int16_t)((node.ambientTemp + 50.0) * 10.0);
+    int16_t tempEncoded = (int16_t)((frame.ambientTemp + 50.0) * 10.0);
     payload.push_back((tempEncoded >> 8) & 0xFF);
     payload.push_back(tempEncoded & 0xFF);
 
     // Humidity (1 byte, 0-100)
-    payload.push_back((uint8_t)constrain(node.humidity, 0.0, 100.0));
+    payload.push_back((uint8_t)constrain(frame.humidity, 0.0, 100.0));
     
     // Irrigation Status (1 byte)
-    payload.push_back((uint8_t)node.irrigationStatus);
+    payload.push_back((uint8_t)frame.irrigationStatus);
 
     // Simulated RSSI (1 byte) -> Decoder faz "- 128"
     int8_t simulatedRssi = random(-95, -50); 
@@ -181,7 +297,7 @@ std::vector<uint8_t> AgriNodeLoRaTx::_createBinaryPayload(const AgriculturalNode
 
     // 3. Timestamp (Opcional, 4 bytes)
     #if ENABLE_NODE_TIMESTAMP
-    uint32_t ts = node.dataTimestamp;
+    uint32_t ts = frame.dataTimestamp;
     payload.push_back((ts >> 24) & 0xFF);
     payload.push_back((ts >> 16) & 0xFF);
     payload.push_back((ts >> 8) & 0xFF);
@@ -196,12 +312,16 @@ void AgriNodeLoRaTx::getStatistics(uint32_t& sent, uint32_t& failed) {
     failed = _packetsFailed;
 }
 
-void AgriNodeLoRaTx::_blinkLED(uint8_t times) {
-    for (uint8_t i = 0; i < times; i++) {
-        digitalWrite(LED_STATUS, HIGH);
-        delay(50);
-        digitalWrite(LED_STATUS, LOW);
-        delay(50);
-    }
-    digitalWrite(LED_STATUS, HIGH); // Mantém ligado (Active Low/High depende da placa, aqui assumimos HIGH = ON)
-}
\ No newline at end of file
+void AgriNodeLoRaTx::_recordAttempt(bool lost) {
+    _channelBusy = (uint8_t)((_channelBusy * 3 + (lost ? 100 : 0)) / 4);
+}
+
+uint8_t AgriNodeLoRaTx::getTxLoad() const {
+    uint8_t occupancy = (uint8_t)(_queue.size() * 100 / TX_QUEUE_CAPACITY);
+    return occupancy > _channelBusy ? occupancy : _channelBusy;
+}
+
+void AgriNodeLoRaTx::getQueueStatistics(uint8_t& pending, uint32_t& coalesced, uint32_t& dropped, uint32_t& alarms) {
+    pending = _queue.size();
+    _queue.getStatistics(coalesced, dropped, alarms);
+}
@@ -0,0 +1,91 @@
+/**
+ * @file AgriNode_MemoryMonitor.cpp
+ * @brief Amostragem de high-water mark das pilhas e do heap
+ */
+#include "AgriNode_MemoryMonitor.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_heap_caps.h>
+
+static const char* const memmonTaskNames[] = { MEMMON_TASK_NAMES };
+
+AgriNodeMemoryMonitor::AgriNodeMemoryMonitor() :
+    AgriNodeTask("memmon"),
+    _watch(),
+    _watchCount(0),
+    _heapFree(0),
+    _heapMinFree(0),
+    _largestBlock(0),
+    _largestBlockMin(UINT32_MAX),
+    _samples(0)
+{
+}
+
+void AgriNodeMemoryMonitor::begin() {
+    _watchCount = 0;
+    for (uint8_t i = 0; i < sizeof(memmonTaskNames) / sizeof(memmonTaskNames[0]); i++) {
+        if (_watchCount >= MEMMON_MAX_TASKS) break;
+        TaskWatch& w = _watch[_watchCount++];
+        w.name = memmonTaskNames[i];
+        w.minFreeBytes = UINT32_MAX;
+        w.running = false;
+        w.warned = false;
+    }
+    sample();
+}
+
+void AgriNodeMemoryMonitor::sample() {
+    for (uint8_t i = 0; i < _watchCount; i++) {
+        TaskWatch& w = _watch[i];
+        TaskHandle_t handle = xTaskGetHandle(w.name);
+        w.running = handle != nullptr;
+        if (!w.running) continue;
+
+        // No ESP-IDF a pilha é medida em bytes (StackType_t = uint8_t)
+        uint32_t freeBytes = uxTaskGetStackHighWaterMark(handle);
+        if (freeBytes < w.minFreeBytes) w.minFreeBytes = freeBytes;
+
+        if (!w.warned && freeBytes < MEMMON_STACK_WARN_BYTES) {
+            w.warned = true;
+            DEBUG_PRINTF("[MEM] ALERTA: pilha de '%s' com só %lu bytes de folga\n",
+                         w.name, (unsigned long)freeBytes);
+        }
+    }
+
+    _heapFree = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    _heapMinFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    _largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    // O mínimo do maior bloco só existe aqui: o heap não o registra
+    if (_largestBlock < _largestBlockMin) _largestBlockMin = _largestBlock;
+    _samples++;
+}
+
+TaskStatus AgriNodeMemoryMonitor::run() {
+    TASK_BEGIN();
+    while (true) {
+        TASK_SLEEP(MEMMON_INTERVAL_MS);
+        sample();
+    }
+    TASK_END();
+}
+
+void AgriNodeMemoryMonitor::printReport() {
+    DEBUG_PRINTF("  Heap:        %lu livre (mín %lu) | maior bloco %lu (mín %lu)\n",
+                 (unsigned long)_heapFree, (unsigned long)_heapMinFree,
+                 (unsigned long)_largestBlock, (unsigned long)_largestBlockMin);
+    DEBUG_PRINTF("  Pilhas:      folga mínima em bytes (%lu amostras)\n", (unsigned long)_samples);
+    for (uint8_t i = 0; i < _watchCount; i++) {
+        const TaskWatch& w = _watch[i];
+        if (w.minFreeBytes == UINT32_MAX) continue;   // nunca existiu neste boot
+        DEBUG_PRINTF("    %-15s %6lu%s\n", w.name, (unsigned long)w.minFreeBytes,
+                     w.running ? "" : "  (encerrada)");
+    }
+}
+
+void AgriNodeMemoryMonitor::getHeapStatistics(uint32_t& freeNow, uint32_t& minFree,
+                                              uint32_t& largestNow, uint32_t& largestMin) {
+    freeNow = _heapFree;
+    minFree = _heapMinFree;
+    largestNow = _largestBlock;
+    largestMin = _largestBlockMin;
+}
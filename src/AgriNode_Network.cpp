@@ -0,0 +1,276 @@
+/**
+ * @file AgriNode_Network.cpp
+ * @brief Conexão WiFi e sincronização NTP sem bloquear o boot
+ */
+#include "AgriNode_Network.h"
+#include <Preferences.h>
+#include <time.h>
+
+#define FAST_CACHE_MAGIC 0xA6C0FE01UL
+
+// --- ESTADO WiFi (apenas para debug) ---
+static unsigned long wifiEventCount = 0;
+
+// ============ CALLBACK DE EVENTOS ============
+
+static void WiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
+    wifiEventCount++;
+    DEBUG_PRINTF("\n[WiFiEvent #%lu] ", wifiEventCount);
+
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_READY:
+            DEBUG_PRINTLN("WiFi READY");
+            break;
+
+        case ARDUINO_EVENT_WIFI_STA_START:
+            DEBUG_PRINTLN("STA START");
+            break;
+
+        case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+            DEBUG_PRINTLN("STA CONNECTED ao AP");
+            break;
+
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            DEBUG_PRINTLN("STA DISCONNECTED");
+            DEBUG_PRINTF("  Razão: %d - ", info.wifi_sta_disconnected.reason);
+            switch (info.wifi_sta_disconnected.reason) {
+                case 2:   DEBUG_PRINTLN("AUTH_EXPIRE"); break;
+                case 6:   DEBUG_PRINTLN("NOT_AUTHED");  break;
+                case 15:  DEBUG_PRINTLN("4WAY_HANDSHAKE_TIMEOUT"); break;
+                case 39:  DEBUG_PRINTLN("TIMEOUT");     break;
+                case 201: DEBUG_PRINTLN("NO_AP_FOUND"); break;
+                default:  DEBUG_PRINTLN("OUTRA");       break;
+            }
+            break;
+
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            DEBUG_PRINTLN("STA GOT_IP");
+            DEBUG_PRINTF("  IP: %s\n", WiFi.localIP().toString().c_str());
+            break;
+
+        default:
+            DEBUG_PRINTF("Evento genérico: %d\n", event);
+            break;
+    }
+}
+
+AgriNodeNetwork::AgriNodeNetwork() :
+    _state(NET_IDLE),
+    _stateSince(0),
+    _connectedAt(0),
+    _timeSyncedAt(0),
+    _ntpStarted(false),
+    _lastStatus(WL_IDLE_STATUS),
+    _cache(),
+    _cacheValid(false),
+    _fastAttempt(false)
+{
+}
+
+void AgriNodeNetwork::begin() {
+    DEBUG_PRINTLN("\n========================================");
+    DEBUG_PRINTF("[NET] Conectando WiFi: '%s'\n", WIFI_SSID_NAME);
+    DEBUG_PRINTLN("========================================");
+
+    digitalWrite(LED_WIFI, LOW);
+
+    // Sem disconnect(true, true): apagar a config do driver a cada boot
+    // forçava scan completo. O cache próprio (NVS) fica em _cache.
+    WiFi.persistent(false);
+    WiFi.onEvent(WiFiEvent);
+    WiFi.mode(WIFI_STA);
+    WiFi.setTxPower(WIFI_POWER_8_5dBm);
+
+    _loadCache();
+    _startConnect();
+}
+
+void AgriNodeNetwork::_startConnect() {
+    if (!_cacheValid) {
+        _startFullConnect();
+        return;
+    }
+
+    // Conexão direta: sem scan (BSSID + canal) e sem DHCP (lease anterior)
+    DEBUG_PRINTF("[NET] WiFi.begin() rápido: canal %ld, BSSID %02X:%02X:%02X:%02X:%02X:%02X\n",
+                 (long)_cache.channel,
+                 _cache.bssid[0], _cache.bssid[1], _cache.bssid[2],
+                 _cache.bssid[3], _cache.bssid[4], _cache.bssid[5]);
+    WiFi.config(IPAddress(_cache.ip), IPAddress(_cache.gateway),
+                IPAddress(_cache.subnet), IPAddress(_cache.dns));
+    WiFi.begin(WIFI_SSID_NAME, WIFI_PASSWORD, _cache.channel, _cache.bssid);
+    _fastAttempt = true;
+    _lastStatus = WL_IDLE_STATUS;
+    _setState(NET_CONNECTING);
+}
+
+void AgriNodeNetwork::_startFullConnect() {
+    DEBUG_PRINTLN("[NET] WiFi.begin() (scan + DHCP)...");
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    WiFi.begin(WIFI_SSID_NAME, WIFI_PASSWORD);
+    _fastAttempt = false;
+    _lastStatus = WL_IDLE_STATUS;
+    _setState(NET_CONNECTING);
+}
+
+void AgriNodeNetwork::_loadCache() {
+    Preferences prefs;
+    _cacheValid = false;
+    if (!prefs.begin(WIFI_CACHE_NVS_NAMESPACE, true)) return;
+
+    size_t len = prefs.getBytes("fast", &_cache, sizeof(_cache));
+    prefs.end();
+
+    _cacheValid = (len == sizeof(_cache)) && (_cache.magic == FAST_CACHE_MAGIC) &&
+                  (_cache.channel > 0) && (_cache.ip != 0);
+    DEBUG_PRINTF("[NET] Cache de conexão rápida: %s\n", _cacheValid ? "OK" : "ausente");
+}
+
+void AgriNodeNetwork::_saveCache() {
+    FastConnectCache fresh = {};
+    fresh.magic = FAST_CACHE_MAGIC;
+    const uint8_t* bssid = WiFi.BSSID();
+    if (bssid == nullptr) return;
+    memcpy(fresh.bssid, bssid, sizeof(fresh.bssid));
+    fresh.channel = WiFi.channel();
+    fresh.ip      = (uint32_t)WiFi.localIP();
+    fresh.gateway = (uint32_t)WiFi.gatewayIP();
+    fresh.subnet  = (uint32_t)WiFi.subnetMask();
+    fresh.dns     = (uint32_t)WiFi.dnsIP();
+
+    // Evita gravar em flash quando nada mudou (reconexões rápidas)
+    if (_cacheValid && memcmp(&fresh, &_cache, sizeof(fresh)) == 0) return;
+
+    Preferences prefs;
+    if (!prefs.begin(WIFI_CACHE_NVS_NAMESPACE, false)) return;
+    prefs.putBytes("fast", &fresh, sizeof(fresh));
+    prefs.end();
+
+    _cache = fresh;
+    _cacheValid = true;
+    DEBUG_PRINTLN("[NET] Cache de conexão rápida atualizado");
+}
+
+void AgriNodeNetwork::update() {
+    unsigned long now = millis();
+    int st = WiFi.status();
+
+    if (st != _lastStatus) {
+        _lastStatus = st;
+        _printStatus(st);
+    }
+
+    switch (_state) {
+        case NET_IDLE:
+            break;
+
+        case NET_CONNECTING:
+            if (st == WL_CONNECTED) {
+                _onConnected();
+                break;
+            }
+            digitalWrite(LED_WIFI, (now / 100) % 2 ? HIGH : LOW);
+
+            if (_fastAttempt &&
+                (now - _stateSince >= WIFI_FAST_CONNECT_TIMEOUT_MS ||
+                 st == WL_NO_SSID_AVAIL || st == WL_CONNECT_FAILED)) {
+                // AP mudou de canal/BSSID ou lease expirou: volta ao fluxo completo
+                DEBUG_PRINTLN("[NET] Conexão rápida falhou, fazendo scan + DHCP");
+                WiFi.disconnect();
+                _startFullConnect();
+                break;
+            }
+
+            if (now - _stateSince >= WIFI_CONNECT_TIMEOUT_MS) {
+                digitalWrite(LED_WIFI, LOW);
+                DEBUG_PRINTLN("\n❌ WiFi NÃO conectou dentro do timeout");
+                WiFi.disconnect();
+                _setState(NET_BACKOFF);
+            }
+            break;
+
+        case NET_CONNECTED:
+            if (st != WL_CONNECTED) {
+                DEBUG_PRINTLN("[NET] Conexão perdida, reconectando...");
+                digitalWrite(LED_WIFI, LOW);
+                _startConnect();
+            }
+            break;
+
+        case NET_BACKOFF:
+            if (now - _stateSince >= WIFI_RETRY_BACKOFF_MS) {
+                _startConnect();
+            }
+            break;
+    }
+
+    _checkTimeSync();
+}
+
+void AgriNodeNetwork::_onConnected() {
+    unsigned long assocMs = millis() - _stateSince;
+    digitalWrite(LED_WIFI, HIGH);
+    _setState(NET_CONNECTED);
+    if (_connectedAt == 0) _connectedAt = millis();
+    _saveCache();
+
+    DEBUG_PRINTLN("\n✅ WiFi CONECTADO!");
+    DEBUG_PRINTF("   Associação: %lu ms (%s)\n", assocMs, _fastAttempt ? "rápida" : "scan + DHCP");
+    DEBUG_PRINTF("   IP: %s\n", WiFi.localIP().toString().c_str());
+    DEBUG_PRINTF("   RSSI: %d dBm | Canal: %d\n", WiFi.RSSI(), WiFi.channel());
+    DEBUG_PRINTF("   Gateway: %s\n", WiFi.gatewayIP().toString().c_str());
+
+    if (!_ntpStarted) {
+        // SNTP roda em background; _checkTimeSync() detecta quando o relógio fica válido
+        DEBUG_PRINTLN("[NET] Sincronizando NTP...");
+        configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER_1, NTP_SERVER_2);
+        _ntpStarted = true;
+    }
+}
+
+void AgriNodeNetwork::_checkTimeSync() {
+    if (!_ntpStarted || _timeSyncedAt != 0) return;
+
+    time_t now;
+    time(&now);
+    if ((unsigned long)now >= TIME_VALID_EPOCH_MIN) {
+        _timeSyncedAt = millis();
+        struct tm* timeinfo = localtime(&now);
+        DEBUG_PRINTLN("✅ NTP OK");
+        DEBUG_PRINTF("   Hora: %02d:%02d:%02d\n",
+                     timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
+    } else if (_connectedAt != 0 && millis() - _connectedAt > NTP_SYNC_TIMEOUT_MS) {
+        static bool warned = false;
+        if (!warned) {
+            warned = true;
+            DEBUG_PRINTLN("⚠️  NTP timeout (mas WiFi está ok)");
+        }
+    }
+}
+
+bool AgriNodeNetwork::isConnected() const {
+    return _state == NET_CONNECTED && WiFi.status() == WL_CONNECTED;
+}
+
+bool AgriNodeNetwork::isTimeSynced() const {
+    return _timeSyncedAt != 0;
+}
+
+void AgriNodeNetwork::_setState(NetState state) {
+    _state = state;
+    _stateSince = millis();
+}
+
+void AgriNodeNetwork::_printStatus(int st) {
+    DEBUG_PRINTF("[NET] Status: %d ", st);
+    switch (st) {
+        case WL_IDLE_STATUS:      DEBUG_PRINTLN("(IDLE)");          break;
+        case WL_NO_SSID_AVAIL:    DEBUG_PRINTLN("(NO_SSID)");       break;
+        case WL_SCAN_COMPLETED:   DEBUG_PRINTLN("(SCAN_DONE)");     break;
+        case WL_CONNECTED:        DEBUG_PRINTLN("(CONNECTED)");     break;
+        case WL_CONNECT_FAILED:   DEBUG_PRINTLN("(CONNECT_FAILED)");break;
+        case WL_CONNECTION_LOST:  DEBUG_PRINTLN("(CONNECTION_LOST)");break;
+        case WL_DISCONNECTED:     DEBUG_PRINTLN("(DISCONNECTED)");  break;
+        default:                  DEBUG_PRINTLN("(UNKNOWN)");       break;
+    }
+}
@@ -0,0 +1,97 @@
+/**
+ * @file AgriNode_Noise.cpp
+ * @brief Ziggurat de 128 camadas (RNOR de Marsaglia & Tsang) sobre xorshift32
+ */
+#include "AgriNode_Noise.h"
+#include <math.h>
+
+#define ZIG_LAYERS  128
+#define ZIG_R       3.442619855899      // Início da cauda
+#define ZIG_V       9.91256303526217e-3 // Área de cada camada
+
+// Compartilhadas por todas as instâncias; preenchidas no primeiro construtor
+static uint32_t zigK[ZIG_LAYERS];       // Limite inteiro do caminho rápido por camada
+static float    zigW[ZIG_LAYERS];       // Inteiro de 32 bits -> x
+static float    zigF[ZIG_LAYERS];       // exp(-x²/2) na borda da camada
+static bool     zigReady = false;
+
+static void zigSetup() {
+    const double m1 = 2147483648.0;
+    double dn = ZIG_R, tn = dn;
+    double q = ZIG_V / exp(-0.5 * dn * dn);
+
+    zigK[0] = (uint32_t)((dn / q) * m1);
+    zigK[1] = 0;
+    zigW[0] = (float)(q / m1);
+    zigW[ZIG_LAYERS - 1] = (float)(dn / m1);
+    zigF[0] = 1.0f;
+    zigF[ZIG_LAYERS - 1] = (float)exp(-0.5 * dn * dn);
+
+    for (int i = ZIG_LAYERS - 2; i >= 1; i--) {
+        dn = sqrt(-2.0 * log(ZIG_V / dn + exp(-0.5 * dn * dn)));
+        zigK[i + 1] = (uint32_t)((dn / tn) * m1);
+        tn = dn;
+        zigF[i] = (float)exp(-0.5 * dn * dn);
+        zigW[i] = (float)(dn / m1);
+    }
+    zigReady = true;
+}
+
+// |hz| sem o UB de abs(INT32_MIN)
+static inline uint32_t zigAbs(int32_t hz) {
+    return hz < 0 ? (uint32_t)0 - (uint32_t)hz : (uint32_t)hz;
+}
+
+AgriNodeNoise::AgriNodeNoise(uint32_t seed) :
+    _state(0)
+{
+    if (!zigReady) zigSetup();
+    this->seed(seed);
+}
+
+void AgriNodeNoise::seed(uint32_t seed) {
+    _state = seed ? seed : 2463534242UL;   // xorshift não sai do zero
+}
+
+float AgriNodeNoise::uniform() {
+    // 24 bits de mantissa + meio passo: sempre dentro de (0, 1)
+    return ((_next() >> 8) + 0.5f) * (1.0f / 16777216.0f);
+}
+
+float AgriNodeNoise::gaussian() {
+    int32_t hz = (int32_t)_next();
+    uint8_t iz = hz & (ZIG_LAYERS - 1);
+    if (zigAbs(hz) < zigK[iz]) return hz * zigW[iz];
+    return _tail(hz, iz);
+}
+
+void AgriNodeNoise::fill(float* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        int32_t hz = (int32_t)_next();
+        uint8_t iz = hz & (ZIG_LAYERS - 1);
+        out[i] = zigAbs(hz) < zigK[iz] ? hz * zigW[iz] : _tail(hz, iz);
+    }
+}
+
+float AgriNodeNoise::_tail(int32_t hz, uint8_t iz) {
+    for (;;) {
+        float x = hz * zigW[iz];
+
+        // Camada da base: amostra a cauda além de ZIG_R (Marsaglia, 1964)
+        if (iz == 0) {
+            float y;
+            do {
+                x = -logf(uniform()) * (float)(1.0 / ZIG_R);
+                y = -logf(uniform());
+            } while (y + y < x * x);
+            return hz > 0 ? (float)ZIG_R + x : -(float)ZIG_R - x;
+        }
+
+        // Borda da camada: aceita sob a curva
+        if (zigF[iz] + uniform() * (zigF[iz - 1] - zigF[iz]) < expf(-0.5f * x * x)) return x;
+
+        hz = (int32_t)_next();
+        iz = hz & (ZIG_LAYERS - 1);
+        if (zigAbs(hz) < zigK[iz]) return hz * zigW[iz];
+    }
+}
@@ -0,0 +1,120 @@
+/**
+ * @file AgriNode_Profiler.cpp
+ * @brief ISR de amostragem (lê mepc) e dump do histograma
+ */
+#include "AgriNode_Profiler.h"
+
+#if AGRINODE_PROFILER
+
+#if !defined(__riscv)
+#error "AGRINODE_PROFILER: leitura do PC interrompido (mepc) implementada só para RISC-V (ESP32-C3)"
+#endif
+
+#define PROFILER_SLOTS (1u << PROFILER_SLOTS_BITS)
+
+struct ProfilerSlot {
+    uint32_t pc;      // 0 = livre
+    uint32_t count;
+};
+
+// Estado compartilhado com a ISR (DRAM; a ISR roda em IRAM)
+static ProfilerSlot profSlots[PROFILER_SLOTS];
+static volatile uint32_t profSamples = 0;
+static volatile uint32_t profDropped = 0;
+static volatile uint16_t profUsed = 0;
+
+static void IRAM_ATTR onProfilerTick() {
+    // mepc ainda guarda o PC interrompido: lido antes de qualquer outra coisa
+    // para reduzir a janela em que uma interrupção aninhada o sobrescreveria
+    uint32_t pc;
+    __asm__ volatile("csrr %0, mepc" : "=r"(pc));
+
+    profSamples++;
+
+    // Hash multiplicativo (instruções comprimidas: PC alinhado em 2 bytes)
+    uint32_t h = ((pc >> 1) * 2654435761u) >> (32 - PROFILER_SLOTS_BITS);
+    for (uint8_t i = 0; i < PROFILER_PROBE_MAX; i++) {
+        ProfilerSlot& slot = profSlots[(h + i) & (PROFILER_SLOTS - 1)];
+        if (slot.pc == pc) {
+            slot.count++;
+            return;
+        }
+        if (slot.pc == 0) {
+            slot.pc = pc;
+            slot.count = 1;
+            profUsed++;
+            return;
+        }
+    }
+    profDropped++;        // tabela saturada nessa vizinhança
+}
+
+AgriNodeProfiler::AgriNodeProfiler() :
+    _timer(nullptr),
+    _sampleHz(0),
+    _windowStart(0)
+{
+}
+
+bool AgriNodeProfiler::begin(uint32_t sampleHz) {
+    if (sampleHz == 0 || sampleHz > 20000) return false;
+
+    // Divisor 80 sobre o APB de 80 MHz: 1 tick = 1 us
+    _timer = timerBegin(PROFILER_TIMER_NUM, 80, true);
+    if (_timer == nullptr) {
+        DEBUG_PRINTLN("[PROF] Timer indisponível");
+        return false;
+    }
+
+    _sampleHz = sampleHz;
+    reset();
+    timerAttachInterrupt(_timer, onProfilerTick, true);
+    timerAlarmWrite(_timer, 1000000UL / sampleHz, true);
+    timerAlarmEnable(_timer);
+
+    DEBUG_PRINTF("[PROF] Amostrando PC a %lu Hz (%u slots)\n", sampleHz, PROFILER_SLOTS);
+    return true;
+}
+
+void AgriNodeProfiler::stop() {
+    if (_timer == nullptr) return;
+    timerAlarmDisable(_timer);
+    timerDetachInterrupt(_timer);
+    timerEnd(_timer);
+    _timer = nullptr;
+}
+
+void AgriNodeProfiler::reset() {
+    if (_timer != nullptr) timerAlarmDisable(_timer);
+    memset(profSlots, 0, sizeof(profSlots));
+    profSamples = 0;
+    profDropped = 0;
+    profUsed = 0;
+    _windowStart = millis();
+    if (_timer != nullptr) timerAlarmEnable(_timer);
+}
+
+void AgriNodeProfiler::dump(Print& out) {
+    if (_timer != nullptr) timerAlarmDisable(_timer);
+
+    // Formato lido por tools/profile_symbolize.py (uma linha "pc contagem" por slot)
+    out.printf("[PROF] BEGIN hz=%lu ms=%lu samples=%lu dropped=%lu slots=%u\n",
+               (unsigned long)_sampleHz, millis() - _windowStart,
+               (unsigned long)profSamples, (unsigned long)profDropped, profUsed);
+    for (uint32_t i = 0; i < PROFILER_SLOTS; i++) {
+        const ProfilerSlot& slot = profSlots[i];
+        if (slot.pc == 0) continue;
+        out.printf("[PROF] 0x%08lx %lu\n", (unsigned long)slot.pc, (unsigned long)slot.count);
+    }
+    out.printf("[PROF] END\n");
+
+    if (_timer != nullptr) timerAlarmEnable(_timer);
+}
+
+void AgriNodeProfiler::getStatistics(uint32_t& samples, uint32_t& dropped, uint16_t& usedSlots) {
+    samples = profSamples;
+    dropped = profDropped;
+    usedSlots = profUsed;
+}
+
+#endif // AGRINODE_PROFILER
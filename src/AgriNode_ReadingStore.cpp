@@ -0,0 +1,375 @@
+/**
+ * @file AgriNode_ReadingStore.cpp
+ * @brief Segmentos em anel na partição "readings": anexação em páginas, selagem, rodízio e consultas por epoch
+ */
+#include "AgriNode_ReadingStore.h"
+#include <time.h>
+
+#define STORE_MAGIC          0x5EC7
+#define STORE_SLOTS          (STORE_SEGMENT_BYTES / sizeof(StoredReading))   // slot 0 = cabeçalho
+#define STORE_PAGE_RECORDS   (STORE_PAGE_BYTES / sizeof(StoredReading))
+#define STORE_UNSEALED       0xFFFFFFFFUL   // bytes ainda apagados
+#define STORE_SEAL_ERASED    0xFFFF
+
+// Ocupa o slot 0; sealCrc/minEpoch/maxEpoch ficam apagados até o segmento
+// fechar. O CRC denuncia uma selagem cortada pela queda de energia
+struct StoreSegmentHeader {
+    uint16_t magic;
+    uint16_t sealCrc;         // CRC-16 de seq + intervalo de epochs
+    uint32_t seq;
+    uint32_t minEpoch;
+    uint32_t maxEpoch;
+};
+static_assert(sizeof(StoreSegmentHeader) == sizeof(StoredReading), "cabeçalho ocupa um slot");
+
+AgriNodeReadingStore::AgriNodeReadingStore() :
+    AgriNodeTask("store"),
+    _partition(nullptr),
+    _index(),
+    _segmentCount(0),
+    _head(0),
+    _writeSlot(1),
+    _page(),
+    _pageFill(0),
+    _stored(0),
+    _dropped(0),
+    _crcErrors(0),
+    _writeErrors(0)
+{
+}
+
+bool AgriNodeReadingStore::begin() {
+    _partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                          (esp_partition_subtype_t)STORE_PARTITION_SUBTYPE,
+                                          STORE_PARTITION_LABEL);
+    if (_partition == nullptr) {
+        DEBUG_PRINTLN("[STORE] ERRO: partição '" STORE_PARTITION_LABEL "' ausente; armazenamento desativado");
+        return false;
+    }
+
+    _segmentCount = _partition->size / STORE_SEGMENT_BYTES;
+    if (_segmentCount > STORE_MAX_SEGMENTS) _segmentCount = STORE_MAX_SEGMENTS;
+    if (_segmentCount < 2) {
+        _partition = nullptr;
+        return false;
+    }
+
+    // Só cabeçalhos: segmentos fechados já trazem o intervalo de epochs
+    uint32_t maxSeq = 0;
+    for (uint16_t s = 0; s < _segmentCount; s++) {
+        StoreSegmentHeader hdr;
+        SegmentInfo& info = _index[s];
+        info.seq = 0;
+        if (esp_partition_read(_partition, _offset(s, 0), &hdr, sizeof(hdr)) != ESP_OK ||
+            hdr.magic != STORE_MAGIC || hdr.seq == 0 || hdr.seq == STORE_UNSEALED) {
+            continue;
+        }
+        info.seq = hdr.seq;
+        if (hdr.minEpoch != STORE_UNSEALED && hdr.sealCrc == _sealCrc(hdr)) {
+            info.minEpoch = hdr.minEpoch;
+            info.maxEpoch = hdr.maxEpoch;
+        } else {
+            // Aberto ou selagem cortada: o intervalo sai da varredura abaixo
+            info.minEpoch = STORE_UNSEALED;
+            info.maxEpoch = STORE_UNSEALED;
+        }
+        if (hdr.seq > maxSeq) {
+            maxSeq = hdr.seq;
+            _head = s;
+        }
+    }
+
+    if (maxSeq == 0) {
+        _openSegment(0, 1);
+        _head = 0;
+        DEBUG_PRINTF("[STORE] Partição vazia: %d segmentos de %d bytes\n", _segmentCount, STORE_SEGMENT_BYTES);
+        return true;
+    }
+
+    // Abertos = o atual ou um que a queda de energia impediu de fechar (ou
+    // cortou no meio da selagem: esse é relido a cada boot até ser reciclado)
+    for (uint16_t s = 0; s < _segmentCount; s++) {
+        SegmentInfo& info = _index[s];
+        if (info.seq == 0) continue;
+        if (info.minEpoch != STORE_UNSEALED) {
+            _stored += STORE_SLOTS - 1;
+            // Queda entre fechar o atual e abrir o próximo: abre agora
+            if (s == _head) _writeSlot = STORE_SLOTS;
+            continue;
+        }
+        uint16_t used = _scanSegment(s);
+        if (s == _head) {
+            _writeSlot = used;
+        } else {
+            _sealSegment(s);
+        }
+    }
+    if (_writeSlot >= STORE_SLOTS) _advance();
+
+    DEBUG_PRINTF("[STORE] %lu registros em %d segmentos | atual %d (slot %d) | %lu CRC inválidos\n",
+                 (unsigned long)_stored, _segmentCount, _head, _writeSlot, (unsigned long)_crcErrors);
+    return true;
+}
+
+TaskStatus AgriNodeReadingStore::run() {
+    TASK_BEGIN();
+
+    while (true) {
+        TASK_SLEEP(STORE_FLUSH_INTERVAL_MS);
+        flush();
+    }
+
+    TASK_END();
+}
+
+bool AgriNodeReadingStore::appendNode(const AgriculturalNode& node) {
+    StoredReading r;
+    r.epoch = node.dataTimestamp;
+    r.sourceId = node.nodeId;
+    r.kind = READING_NODE;
+    r.status = node.irrigationStatus;
+    r.value[0] = _scale(node.soilMoisture);
+    r.value[1] = _scale(node.ambientTemp);
+    r.value[2] = _scale(node.humidity);
+    return _append(r);
+}
+
+bool AgriNodeReadingStore::appendSample(uint16_t sensorId, float value) {
+    time_t now;
+    time(&now);
+
+    StoredReading r;
+    r.epoch = ((unsigned long)now >= TIME_VALID_EPOCH_MIN) ? (uint32_t)now : 0;
+    r.sourceId = sensorId;
+    r.kind = READING_SENSOR;
+    r.status = 0;
+    r.value[0] = _scale(value);
+    r.value[1] = 0;
+    r.value[2] = 0;
+    return _append(r);
+}
+
+bool AgriNodeReadingStore::_append(StoredReading& r) {
+    if (_partition == nullptr) return false;
+
+    r.crc = _crc16((const uint8_t*)&r, offsetof(StoredReading, crc));
+    _page[_pageFill++] = r;
+
+    SegmentInfo& info = _index[_head];
+    if (r.epoch != 0) {
+        if (r.epoch < info.minEpoch) info.minEpoch = r.epoch;
+        if (r.epoch > info.maxEpoch) info.maxEpoch = r.epoch;
+    }
+    _stored++;
+
+    // Escreve ao completar a página de flash (a primeira do segmento tem o cabeçalho)
+    uint16_t next = _writeSlot + _pageFill;
+    if (next % STORE_PAGE_RECORDS == 0 || next >= STORE_SLOTS) flush();
+    return true;
+}
+
+void AgriNodeReadingStore::flush() {
+    if (_partition == nullptr || _pageFill == 0) return;
+
+    // Nunca atravessa a página: _append descarrega no limite
+    if (esp_partition_write(_partition, _offset(_head, _writeSlot), _page,
+                            _pageFill * sizeof(StoredReading)) != ESP_OK) {
+        _writeErrors++;
+        DEBUG_PRINTF("[STORE] ERRO: escrita na flash falhou (segmento %d, slot %d)\n", _head, _writeSlot);
+    }
+    // Mesmo com erro o slot avança: bytes meio gravados não passam no CRC
+    _writeSlot += _pageFill;
+    _pageFill = 0;
+
+    if (_writeSlot >= STORE_SLOTS) _advance();
+}
+
+void AgriNodeReadingStore::_advance() {
+    _sealSegment(_head);
+    uint32_t seq = _index[_head].seq + 1;
+    uint16_t next = (_head + 1) % _segmentCount;
+
+    // Anel cheio: o próximo segmento é o mais antigo
+    if (_index[next].seq != 0) {
+        _dropped += STORE_SLOTS - 1;
+        _stored -= (_stored >= STORE_SLOTS - 1) ? STORE_SLOTS - 1 : _stored;
+    }
+    _openSegment(next, seq);
+    _head = next;
+}
+
+void AgriNodeReadingStore::_openSegment(uint16_t segment, uint32_t seq) {
+    // ~45 ms de apagamento por setor, uma vez por volta do anel
+    size_t offset = _offset(segment, 0);
+    SegmentInfo& info = _index[segment];
+    info.seq = 0;
+    if (esp_partition_erase_range(_partition, offset, STORE_SEGMENT_BYTES) != ESP_OK) {
+        _writeErrors++;
+        DEBUG_PRINTF("[STORE] ERRO: apagamento do segmento %d falhou\n", segment);
+    }
+
+    StoreSegmentHeader hdr;
+    hdr.magic = STORE_MAGIC;
+    hdr.sealCrc = STORE_SEAL_ERASED;
+    hdr.seq = seq;
+    hdr.minEpoch = STORE_UNSEALED;
+    hdr.maxEpoch = STORE_UNSEALED;
+    if (esp_partition_write(_partition, offset, &hdr, sizeof(hdr)) != ESP_OK) _writeErrors++;
+
+    info.seq = seq;
+    info.minEpoch = UINT32_MAX;   // em RAM: nenhum epoch ainda
+    info.maxEpoch = 0;
+    _writeSlot = 1;
+}
+
+void AgriNodeReadingStore::_sealSegment(uint16_t segment) {
+    // Já fechado, ou selagem cortada: bits em 0 não voltam a 1 sem apagar,
+    // então não reprograma (o intervalo fica só no índice em RAM)
+    size_t offset = _offset(segment, 0);
+    StoreSegmentHeader hdr;
+    if (esp_partition_read(_partition, offset, &hdr, sizeof(hdr)) != ESP_OK) return;
+    if (hdr.sealCrc != STORE_SEAL_ERASED || hdr.minEpoch != STORE_UNSEALED ||
+        hdr.maxEpoch != STORE_UNSEALED) {
+        return;
+    }
+
+    SegmentInfo& info = _index[segment];
+    // Segmento só com leituras sem epoch: intervalo [0, 0]
+    if (info.minEpoch == UINT32_MAX) {
+        info.minEpoch = 0;
+        info.maxEpoch = 0;
+    }
+    hdr.minEpoch = info.minEpoch;
+    hdr.maxEpoch = info.maxEpoch;
+    hdr.sealCrc = _sealCrc(hdr);
+    // Uma escrita só; seq é regravado com os mesmos bits
+    if (esp_partition_write(_partition, offset + offsetof(StoreSegmentHeader, sealCrc), &hdr.sealCrc,
+                            sizeof(hdr) - offsetof(StoreSegmentHeader, sealCrc)) != ESP_OK) {
+        _writeErrors++;
+    }
+}
+
+uint16_t AgriNodeReadingStore::_sealCrc(const StoreSegmentHeader& hdr) {
+    return _crc16((const uint8_t*)&hdr.seq, sizeof(hdr) - offsetof(StoreSegmentHeader, seq));
+}
+
+uint16_t AgriNodeReadingStore::_scanSegment(uint16_t segment) {
+    SegmentInfo& info = _index[segment];
+    info.minEpoch = UINT32_MAX;
+    info.maxEpoch = 0;
+
+    StoredReading page[STORE_PAGE_RECORDS];
+    uint16_t used = 1;
+    for (uint16_t slot = 0; slot < STORE_SLOTS; slot += STORE_PAGE_RECORDS) {
+        if (esp_partition_read(_partition, _offset(segment, slot), page, sizeof(page)) != ESP_OK) break;
+        for (uint16_t i = (slot == 0) ? 1 : 0; i < STORE_PAGE_RECORDS; i++) {
+            const StoredReading& r = page[i];
+            if (_isErased(r)) continue;
+            used = slot + i + 1;
+            if (r.crc != _crc16((const uint8_t*)&r, offsetof(StoredReading, crc))) {
+                _crcErrors++;     // registro cortado pela queda de energia
+                continue;
+            }
+            _stored++;
+            if (r.epoch != 0) {
+                if (r.epoch < info.minEpoch) info.minEpoch = r.epoch;
+                if (r.epoch > info.maxEpoch) info.maxEpoch = r.epoch;
+            }
+        }
+    }
+    return used;
+}
+
+uint32_t AgriNodeReadingStore::query(uint32_t fromEpoch, uint32_t toEpoch, uint16_t sourceId,
+                                     StoredReadingCallback callback, void* context) {
+    if (_partition == nullptr || callback == nullptr) return 0;
+
+    uint32_t delivered = 0;
+    StoredReading page[STORE_PAGE_RECORDS];
+
+    // Do mais antigo (logo após o atual) até o atual
+    for (uint16_t n = 1; n <= _segmentCount; n++) {
+        uint16_t s = (_head + n) % _segmentCount;
+        const SegmentInfo& info = _index[s];
+        if (info.seq == 0) continue;
+        if (fromEpoch != 0 && (info.maxEpoch < fromEpoch || info.minEpoch > toEpoch)) continue;
+
+        uint16_t end = (s == _head) ? _writeSlot : STORE_SLOTS;
+        for (uint16_t slot = 0; slot < end; slot += STORE_PAGE_RECORDS) {
+            if (esp_partition_read(_partition, _offset(s, slot), page, sizeof(page)) != ESP_OK) break;
+            for (uint16_t i = (slot == 0) ? 1 : 0; i < STORE_PAGE_RECORDS && slot + i < end; i++) {
+                const StoredReading& r = page[i];
+                if (_isErased(r) || r.crc != _crc16((const uint8_t*)&r, offsetof(StoredReading, crc))) continue;
+                if (!_matches(r, fromEpoch, toEpoch, sourceId)) continue;
+                callback(r, context);
+                delivered++;
+            }
+        }
+    }
+
+    // Página ainda em RAM
+    for (uint8_t i = 0; i < _pageFill; i++) {
+        if (!_matches(_page[i], fromEpoch, toEpoch, sourceId)) continue;
+        callback(_page[i], context);
+        delivered++;
+    }
+    return delivered;
+}
+
+static void exportStoredRow(const StoredReading& r, void* context) {
+    Print* out = (Print*)context;
+    out->printf("%d,%u,%lu,%.2f,%.2f,%.2f,%d\n", r.kind, r.sourceId, (unsigned long)r.epoch,
+                r.value[0] / 100.0f, r.value[1] / 100.0f, r.value[2] / 100.0f, r.status);
+}
+
+void AgriNodeReadingStore::exportCsv(Print& out, uint32_t fromEpoch, uint32_t toEpoch) {
+    out.println("kind,sourceId,epoch,v0,v1,v2,status");
+    uint32_t n = query(fromEpoch, toEpoch, 0, exportStoredRow, &out);
+    out.printf("# %lu registros\n", (unsigned long)n);
+}
+
+bool AgriNodeReadingStore::_matches(const StoredReading& r, uint32_t fromEpoch, uint32_t toEpoch,
+                                    uint16_t sourceId) const {
+    if (sourceId != 0 && r.sourceId != sourceId) return false;
+    if (r.epoch > toEpoch) return false;
+    return fromEpoch == 0 || r.epoch >= fromEpoch;
+}
+
+size_t AgriNodeReadingStore::_offset(uint16_t segment, uint16_t slot) const {
+    return (size_t)segment * STORE_SEGMENT_BYTES + (size_t)slot * sizeof(StoredReading);
+}
+
+bool AgriNodeReadingStore::_isErased(const StoredReading& r) {
+    const uint32_t* w = (const uint32_t*)&r;
+    return (w[0] & w[1] & w[2] & w[3]) == 0xFFFFFFFFUL;
+}
+
+uint16_t AgriNodeReadingStore::_crc16(const uint8_t* data, size_t len) {
+    // CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+int16_t AgriNodeReadingStore::_scale(float value) {
+    float v = value * 100.0f;
+    if (v > 32767.0f) return 32767;
+    if (v < -32768.0f) return -32768;
+    return (int16_t)(v < 0 ? v - 0.5f : v + 0.5f);
+}
+
+void AgriNodeReadingStore::getStatistics(uint32_t& stored, uint16_t& segments, uint32_t& dropped,
+                                         uint32_t& crcErrors) {
+    stored = _stored;
+    segments = 0;
+    for (uint16_t s = 0; s < _segmentCount; s++) {
+        if (_index[s].seq != 0) segments++;
+    }
+    dropped = _dropped;
+    crcErrors = _crcErrors;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file AgriNode_SensorScheduler.cpp
+ * @brief Agendador cooperativo de sensores: colhe conversões prontas, dispara as vencidas
+ */
+#include "AgriNode_SensorScheduler.h"
+
+AgriNodeSensorScheduler::AgriNodeSensorScheduler() :
+    _slots(),
+    _count(0),
+    _nextStart(0),
+    _callback(nullptr),
+    _context(nullptr),
+    _readings(0),
+    _errors(0),
+    _deferred(0)
+{
+}
+
+bool AgriNodeSensorScheduler::add(AgriNodeSensorDriver* driver, unsigned long intervalMs) {
+    if (driver == nullptr || _count >= SENSOR_MAX_DRIVERS) return false;
+    Slot& slot = _slots[_count++];
+    slot.driver = driver;
+    slot.intervalMs = intervalMs;
+    slot.dueAt = 0;
+    slot.state = SLOT_DISABLED;
+    slot.deferred = false;
+    return true;
+}
+
+void AgriNodeSensorScheduler::onReading(SensorReadingCallback callback, void* context) {
+    _callback = callback;
+    _context = context;
+}
+
+uint8_t AgriNodeSensorScheduler::begin(unsigned long now) {
+    uint8_t active = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        Slot& slot = _slots[i];
+        if (!slot.driver->begin()) continue;
+        // Espalha a primeira conversão de cada driver para não formar rajadas
+        slot.dueAt = now + (slot.intervalMs * i) / (_count ? _count : 1);
+        slot.state = SLOT_IDLE;
+        active++;
+    }
+    return active;
+}
+
+bool AgriNodeSensorScheduler::_busHeld(SensorBus bus) const {
+    for (uint8_t i = 0; i < _count; i++) {
+        const Slot& s = _slots[i];
+        if (s.state == SLOT_CONVERTING && s.driver->bus() == bus &&
+            s.driver->holdsBusWhileConverting()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AgriNodeSensorScheduler::_reschedule(Slot& slot, unsigned long now) {
+    slot.state = SLOT_IDLE;
+    slot.dueAt += slot.intervalMs;
+    // Atrasou mais de um intervalo (barramento ocupado, rádio): não tenta recuperar ciclos
+    if ((long)(now - slot.dueAt) >= 0) slot.dueAt = now + slot.intervalMs;
+}
+
+void AgriNodeSensorScheduler::update(unsigned long now, unsigned long quietMs) {
+    uint8_t budget = SENSOR_MAX_TRANSACTIONS_PER_TICK;
+
+    // 1) Colhe conversões prontas primeiro: libera barramentos para novas conversões
+    for (uint8_t i = 0; i < _count && budget > 0; i++) {
+        Slot& slot = _slots[i];
+        if (slot.state != SLOT_CONVERTING) continue;
+
+        SensorPoll p = slot.driver->poll(now);
+        if (p == SENSOR_BUSY) continue;
+
+        if (p == SENSOR_READY) {
+            SensorReading out[SENSOR_MAX_READINGS_PER_DRIVER];
+            uint8_t n = slot.driver->read(out, SENSOR_MAX_READINGS_PER_DRIVER, now);
+            budget--;
+            if (n == 0) _errors++;
+            for (uint8_t k = 0; k < n; k++) {
+                _readings++;
+                if (_callback) _callback(out[k], _context);
+            }
+        } else {
+            _errors++;
+        }
+        _reschedule(slot, now);
+    }
+
+    // 2) Dispara conversões vencidas (round-robin) enquanto houver orçamento
+    uint8_t first = _nextStart;
+    for (uint8_t k = 0; k < _count && budget > 0; k++) {
+        uint8_t i = (first + k) % _count;
+        Slot& slot = _slots[i];
+        if (slot.state != SLOT_IDLE || (long)(now - slot.dueAt) < 0) continue;
+
+        AgriNodeSensorDriver* d = slot.driver;
+        if (_busHeld(d->bus())) continue;
+
+        if (d->conversionMs() > quietMs && now - slot.dueAt < SENSOR_MAX_DEFER_MS) {
+            if (!slot.deferred) _deferred++;
+            slot.deferred = true;
+            continue;
+        }
+
+        budget--;
+        slot.deferred = false;
+        if (d->start(now)) {
+            slot.state = SLOT_CONVERTING;
+        } else {
+            _errors++;
+            _reschedule(slot, now);
+        }
+        _nextStart = (i + 1) % _count;
+    }
+}
+
+void AgriNodeSensorScheduler::getStatistics(uint32_t& readings, uint32_t& errors, uint32_t& deferred) {
+    readings = _readings;
+    errors = _errors;
+    deferred = _deferred;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file AgriNode_Sht3x.cpp
+ * @brief SHT3x single-shot sem clock stretching: o barramento fica livre durante a medição
+ */
+#include "AgriNode_Sht3x.h"
+
+AgriNodeSht3x::AgriNodeSht3x(TwoWire& wire, uint8_t address, uint8_t sensorId) :
+    _wire(wire),
+    _address(address),
+    _sensorId(sensorId),
+    _convStartedAt(0)
+{
+}
+
+bool AgriNodeSht3x::begin() {
+    _wire.beginTransmission(_address);
+    if (_wire.endTransmission() != 0) {
+        DEBUG_PRINTF("[SHT3x] Sem resposta em 0x%02X\n", _address);
+        return false;
+    }
+    DEBUG_PRINTF("[SHT3x] Inicializado em 0x%02X\n", _address);
+    return true;
+}
+
+bool AgriNodeSht3x::start(unsigned long now) {
+    // 0x2400: single shot, alta repetibilidade, sem clock stretching
+    _wire.beginTransmission(_address);
+    _wire.write((uint8_t)0x24);
+    _wire.write((uint8_t)0x00);
+    if (_wire.endTransmission() != 0) return false;
+    _convStartedAt = now;
+    return true;
+}
+
+SensorPoll AgriNodeSht3x::poll(unsigned long now) {
+    return (now - _convStartedAt >= SHT3X_CONVERSION_MS) ? SENSOR_READY : SENSOR_BUSY;
+}
+
+uint8_t AgriNodeSht3x::read(SensorReading* out, uint8_t maxReadings, unsigned long now) {
+    if (maxReadings < 2) return 0;
+
+    uint8_t raw[6];
+    if (_wire.requestFrom(_address, (uint8_t)6) != 6) return 0;
+    for (uint8_t i = 0; i < 6; i++) raw[i] = (uint8_t)_wire.read();
+
+    if (_crc8(raw, 2) != raw[2] || _crc8(raw + 3, 2) != raw[5]) {
+        DEBUG_PRINTLN("[SHT3x] CRC inválido");
+        return 0;
+    }
+
+    uint16_t rawT = ((uint16_t)raw[0] << 8) | raw[1];
+    uint16_t rawH = ((uint16_t)raw[3] << 8) | raw[4];
+
+    out[0].sensorId = _sensorId;
+    out[0].kind = SENSOR_TEMPERATURE;
+    out[0].value = -45.0f + 175.0f * rawT / 65535.0f;
+    out[0].takenAt = now;
+
+    out[1].sensorId = _sensorId;
+    out[1].kind = SENSOR_HUMIDITY;
+    out[1].value = 100.0f * rawH / 65535.0f;
+    out[1].takenAt = now;
+    return 2;
+}
+
+uint8_t AgriNodeSht3x::_crc8(const uint8_t* data, uint8_t len) {
+    // Polinômio 0x31, valor inicial 0xFF (datasheet Sensirion)
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
@@ -4,9 +4,55 @@
  */
 #include "AgriNode_Simulator.h"
 #include <time.h>
+#include <algorithm>
+
+// Posição na curva de Hilbert de uma célula (x, y) da grade 2^order x 2^order
+// (conversão xy -> d clássica: células vizinhas na curva são vizinhas no plano)
+static uint32_t hilbertIndex(uint8_t order, uint32_t x, uint32_t y) {
+    const uint32_t n = 1UL << order;
+    uint32_t d = 0;
+    for (uint32_t s = n >> 1; s > 0; s >>= 1) {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+        // Gira o quadrante para a próxima subdivisão
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            uint32_t t = x; x = y; y = t;
+        }
+    }
+    return d;
+}
+
+static uint32_t nodeHilbertKey(const AgriculturalNode& node) {
+    const uint32_t cells = 1UL << NODE_HILBERT_ORDER;
+    float scale = (float)cells / NODE_FIELD_SIZE_M;
+    uint32_t x = (uint32_t)constrain(node.posX * scale, 0.0f, (float)(cells - 1));
+    uint32_t y = (uint32_t)constrain(node.posY * scale, 0.0f, (float)(cells - 1));
+    return hilbertIndex(NODE_HILBERT_ORDER, x, y);
+}
 
 AgriNodeSimulator::AgriNodeSimulator() :
-    _lastGlobalUpdate(0)
+    AgriNodeTask("simulator"),
+    _slotById(),
+    _dirty(),
+    _history(),
+    _lastGlobalUpdate(0),
+    _ambientBaseline(0),
+    _ambientBaselineAt(0),
+    _hasAmbientBaseline(false),
+    _alarmCallback(nullptr),
+    _alarmContext(nullptr),
+    _transitionCallback(nullptr),
+    _transitionContext(nullptr),
+    _updateCallback(nullptr),
+    _updateContext(nullptr),
+    _loadMode(SIM_MODE_NORMAL),
+    _noiseBuf(),
+    _noiseNext(sizeof(_noiseBuf) / sizeof(_noiseBuf[0]))
 {
     // ========================================================================
     // CORREÇÃO CRÍTICA: Inicialização dos Ranges
@@ -22,6 +68,7 @@ bool AgriNodeSimulator::begin() {
     DEBUG_PRINTLN("[AgriNodeSimulator] Inicializando...");
     DEBUG_PRINTLN("========================================");
 
+    _noise.seed((uint32_t)random(1, 0x7FFFFFFF));   // RNG de hardware só para a semente
     _initializeNodes();
     _lastGlobalUpdate = millis();
 
@@ -36,10 +83,12 @@ void AgriNodeSimulator::_initializeNodes() {
     };
     const float baseTemps[NUM_SIMULATED_NODES] = {24.0, 26.0, 22.0, 28.0, 25.0};
     const float baseMoistures[NUM_SIMULATED_NODES] = {45.0, 55.0, 65.0, 40.0, 50.0};
+    // Fração do desvio corrigida por atualização (café sob sombreamento reage mais devagar)
+    const float ambientLags[NUM_SIMULATED_NODES] = {0.30, 0.20, 0.10, 0.25, 0.15};
 
     for (uint8_t i = 0; i < NUM_SIMULATED_NODES; i++) {
         AgriculturalNode& node = _nodes[i];
-        node.nodeId = 1000 + i;
+        node.nodeId = NODE_ID_BASE + i;
         node.cropType = crops[i];
         node.soilMoisture = _addNoise(baseMoistures[i], 10.0);
         node.ambientTemp = _addNoise(baseTemps[i], 5.0);
@@ -52,37 +101,172 @@ void AgriNodeSimulator::_initializeNodes() {
         node.txCount = 0;
         node.lastRssi = 0;
         node.dataTimestamp = 0;
+        node.ambientOffset = baseTemps[i] - _ranges.temperature_avg;
+        node.ambientLag = ambientLags[i];
+        node.posX = random(0, (long)(NODE_FIELD_SIZE_M * 10)) / 10.0f;
+        node.posY = random(0, (long)(NODE_FIELD_SIZE_M * 10)) / 10.0f;
 
         // Agora _ranges contem valores validos, então constrain funciona
         node.soilMoisture = _constrain(node.soilMoisture, _ranges.soilMoisture_min, _ranges.soilMoisture_max);
         node.ambientTemp = _constrain(node.ambientTemp, _ranges.temperature_min, _ranges.temperature_max);
         node.humidity = _constrain(node.humidity, _ranges.humidity_min, _ranges.humidity_max);
     }
+
+    _sortNodesByHilbert();
 }
 
-void AgriNodeSimulator::update() {
-    unsigned long currentTime = millis();
+void AgriNodeSimulator::_sortNodesByHilbert() {
+    // Só no carregamento do cenário: depois disso os slots ficam fixos
+    std::sort(_nodes.begin(), _nodes.end(),
+              [](const AgriculturalNode& a, const AgriculturalNode& b) {
+                  uint32_t ka = nodeHilbertKey(a), kb = nodeHilbertKey(b);
+                  // Desempate por ID: a mesma posição restaurada dá a mesma ordem
+                  return ka != kb ? ka < kb : a.nodeId < b.nodeId;
+              });
+
+    for (uint8_t slot = 0; slot < NUM_SIMULATED_NODES; slot++) {
+        _slotById[_nodes[slot].nodeId - NODE_ID_BASE] = slot;
+    }
+}
+
+TaskStatus AgriNodeSimulator::run() {
+    TASK_BEGIN();
 
-    if (currentTime - _lastGlobalUpdate >= NODE_UPDATE_INTERVAL_MS) {
-        _lastGlobalUpdate = currentTime;
+    while (true) {
+        TASK_SLEEP_UNTIL(_lastGlobalUpdate + _updateInterval());
+        _lastGlobalUpdate = taskNow();
 
         digitalWrite(LED_SIM, HIGH);
+        _updateAllNodes(taskNow());
+        TASK_SLEEP(50);
+        digitalWrite(LED_SIM, LOW);
+    }
 
-        time_t now;
-        time(&now);
+    TASK_END();
+}
 
-        for (auto& node : _nodes) {
-            node.dataTimestamp = (uint32_t)now;
-            _updateNodeSensors(node);
-            _checkIrrigationNeeds(node);
-            node.lastUpdateTime = currentTime;
-        }
+uint32_t AgriNodeSimulator::_currentEpoch() {
+    time_t now;
+    time(&now);
+    // Antes do NTP o relógio é inválido: deixa 0 e preenche em backfillTimestamps()
+    return ((unsigned long)now >= TIME_VALID_EPOCH_MIN) ? (uint32_t)now : 0;
+}
 
-        DEBUG_PRINTLN("[AgriNodeSimulator] Sensores atualizados");
+void AgriNodeSimulator::_updateAllNodes(unsigned long currentTime) {
+    uint32_t ts = _currentEpoch();
 
-        delay(50);
-        digitalWrite(LED_SIM, LOW);
+    // Sem leitura recente do DS18B20, volta ao modelo senoidal
+    bool fromAmbient = hasFreshAmbient();
+
+    // Ruído de todos os nós numa passada
+    _noise.fill(_noiseBuf, sizeof(_noiseBuf) / sizeof(_noiseBuf[0]));
+    _noiseNext = 0;
+
+    for (auto& node : _nodes) {
+        _updateNode(node, ts, fromAmbient, currentTime);
     }
+
+    DEBUG_PRINTF("[AgriNodeSimulator] Sensores atualizados (%s)\n", loadModeName(_loadMode));
+}
+
+void AgriNodeSimulator::_updateNode(AgriculturalNode& node, uint32_t ts, bool fromAmbient,
+                                    unsigned long now) {
+    node.dataTimestamp = ts;
+    if (fromAmbient) {
+        _updateNodeFromAmbient(node);
+    } else {
+        _updateNodeSensors(node);
+    }
+    _checkIrrigationNeeds(node);
+    node.lastUpdateTime = now;
+    markDirty(node);
+
+    HistoryReading reading;
+    reading.time = now / 1000UL;
+    reading.soilMoisture = node.soilMoisture;
+    reading.ambientTemp = node.ambientTemp;
+    reading.humidity = node.humidity;
+    reading.irrigationStatus = node.irrigationStatus;
+    _history[node.nodeId - NODE_ID_BASE].append(reading);
+
+    if (_updateCallback) _updateCallback(node, _updateContext);
+}
+
+unsigned long AgriNodeSimulator::_updateInterval() const {
+    switch (_loadMode) {
+        case SIM_MODE_SLOW:    return NODE_UPDATE_INTERVAL_MS * SIM_BACKPRESSURE_SLOW_FACTOR;
+        case SIM_MODE_SUMMARY: return NODE_UPDATE_INTERVAL_MS * SIM_BACKPRESSURE_SUMMARY_FACTOR;
+        default:               return NODE_UPDATE_INTERVAL_MS;
+    }
+}
+
+void AgriNodeSimulator::setTxLoad(uint8_t percent) {
+    SimLoadMode mode = SIM_MODE_NORMAL;
+    if (percent >= SIM_BACKPRESSURE_SUMMARY_PCT) mode = SIM_MODE_SUMMARY;
+    else if (percent >= SIM_BACKPRESSURE_SLOW_PCT) mode = SIM_MODE_SLOW;
+
+    if (mode != _loadMode) {
+        DEBUG_PRINTF("[AgriNodeSimulator] Carga do rádio %d%%: modo %s -> %s\n",
+                     percent, loadModeName(_loadMode), loadModeName(mode));
+        _loadMode = mode;
+    }
+}
+
+const char* AgriNodeSimulator::loadModeName(SimLoadMode mode) {
+    switch (mode) {
+        case SIM_MODE_SLOW:    return "lento";
+        case SIM_MODE_SUMMARY: return "resumo";
+        default:               return "normal";
+    }
+}
+
+void AgriNodeSimulator::refreshIfStale(AgriculturalNode& node, unsigned long now) {
+    // Fora do modo resumo o tick periódico já mantém a leitura recente
+    if (_loadMode != SIM_MODE_SUMMARY) return;
+    if (now - node.lastUpdateTime < NODE_UPDATE_INTERVAL_MS) return;
+    _updateNode(node, _currentEpoch(), hasFreshAmbient(), now);
+}
+
+void AgriNodeSimulator::backfillTimestamps() {
+    time_t now;
+    time(&now);
+    if ((unsigned long)now < TIME_VALID_EPOCH_MIN) return;
+
+    // Reconstrói o epoch de cada leitura a partir da idade em millis()
+    unsigned long currentTime = millis();
+    uint8_t filled = 0;
+    for (auto& node : _nodes) {
+        if (node.dataTimestamp != 0) continue;
+        node.dataTimestamp = (uint32_t)now - (uint32_t)((currentTime - node.lastUpdateTime) / 1000UL);
+        filled++;
+    }
+    DEBUG_PRINTF("[AgriNodeSimulator] Timestamps preenchidos após NTP: %d nós\n", filled);
+}
+
+void AgriNodeSimulator::onAlarm(NodeAlarmCallback callback, void* context) {
+    _alarmCallback = callback;
+    _alarmContext = context;
+}
+
+void AgriNodeSimulator::onTransition(NodeTransitionCallback callback, void* context) {
+    _transitionCallback = callback;
+    _transitionContext = context;
+}
+
+void AgriNodeSimulator::onUpdate(NodeUpdateCallback callback, void* context) {
+    _updateCallback = callback;
+    _updateContext = context;
+}
+
+void AgriNodeSimulator::setAmbientBaseline(float tempC) {
+    _ambientBaseline = tempC;
+    _ambientBaselineAt = millis();
+    _hasAmbientBaseline = true;
+}
+
+bool AgriNodeSimulator::hasFreshAmbient() const {
+    return SIM_AMBIENT_FROM_DS18B20 && _hasAmbientBaseline &&
+           millis() - _ambientBaselineAt < SIM_AMBIENT_STALE_MS;
 }
 
 void AgriNodeSimulator::_updateNodeSensors(AgriculturalNode& node) {
@@ -103,6 +287,20 @@ void AgriNodeSimulator::_updateNodeSensors(AgriculturalNode& node) {
     // Usa _ranges.temperature_avg (agora inicializado corretamente)
     float targetTemp = _ranges.temperature_avg + tempVariation;
     node.ambientTemp = node.ambientTemp * 0.9 + targetTemp * 0.1;
+    _finishNodeSensors(node, tempVariation);
+}
+
+void AgriNodeSimulator::_updateNodeFromAmbient(AgriculturalNode& node) {
+    // DS18B20 real como referência: cada nó segue com seu offset de microclima
+    // e sua própria inércia térmica (sem localtime()/sin())
+    float targetTemp = _ambientBaseline + node.ambientOffset;
+    node.ambientTemp += (targetTemp - node.ambientTemp) * node.ambientLag;
+
+    // Mesmo acoplamento temperatura -> umidade do modelo sintético
+    _finishNodeSensors(node, _ambientBaseline - _ranges.temperature_avg);
+}
+
+void AgriNodeSimulator::_finishNodeSensors(AgriculturalNode& node, float tempVariation) {
     node.ambientTemp = _addNoise(node.ambientTemp, 2.0);
     node.ambientTemp = _constrain(node.ambientTemp, _ranges.temperature_min, _ranges.temperature_max);
 
@@ -116,7 +314,7 @@ void AgriNodeSimulator::_updateNodeSensors(AgriculturalNode& node) {
         node.soilMoisture += random(30, 50) / 10.0;
         node.soilMoisture = _constrain(node.soilMoisture, 0.0, _ranges.soilMoisture_max);
         if (node.soilMoisture >= 70.0) {
-            node.irrigationStatus = IRRIGATION_OFF;
+            _setIrrigation(node, IRRIGATION_OFF);
             DEBUG_PRINTF("[Node %d] Irrigação desligada (umidade: %.1f%%)\n", node.nodeId, node.soilMoisture);
         }
     } else {
@@ -130,23 +328,43 @@ void AgriNodeSimulator::_updateNodeSensors(AgriculturalNode& node) {
 void AgriNodeSimulator::_checkIrrigationNeeds(AgriculturalNode& node) {
     if (node.soilMoisture < _ranges.soilMoisture_critical) {
         if (node.irrigationStatus == IRRIGATION_OFF) {
-            node.irrigationStatus = IRRIGATION_ON;
+            _setIrrigation(node, IRRIGATION_ON);
             node.needsIrrigation = true;
             DEBUG_PRINTF("[Node %d] ALERTA: Irrigação ativada (umidade: %.1f%%)\n", node.nodeId, node.soilMoisture);
+            if (_alarmCallback) _alarmCallback(node, _alarmContext);
         }
     } else {
         node.needsIrrigation = false;
     }
 
-    if (random(0, 1000) == 0) {
-        node.irrigationStatus = IRRIGATION_ERROR;
+    // Já em erro: sem nova transição, sem novo alarme
+    if (random(0, 1000) == 0 && _setIrrigation(node, IRRIGATION_ERROR)) {
         DEBUG_PRINTF("[Node %d] ERRO: Falha no sistema de irrigação\n", node.nodeId);
+        if (_alarmCallback) _alarmCallback(node, _alarmContext);
     }
 }
 
+bool AgriNodeSimulator::_setIrrigation(AgriculturalNode& node, IrrigationStatus status) {
+    IrrigationStatus from = node.irrigationStatus;
+    if (from == status) return false;
+    node.irrigationStatus = status;
+    if (_transitionCallback) _transitionCallback(node, from, _transitionContext);
+    return true;
+}
+
 float AgriNodeSimulator::_addNoise(float value, float noisePercent) {
-    float noise = (random(-100, 100) / 100.0) * (value * noisePercent / 100.0);
-    return value + noise;
+    // Gaussiano com o mesmo desvio-padrão do antigo uniforme em ±noisePercent%:
+    // sigma = pct * valor / 100 / sqrt(3)
+    return value + _nextNoise() * (value * noisePercent * (0.01f / 1.7320508f));
+}
+
+float AgriNodeSimulator::_nextNoise() {
+    const uint8_t size = sizeof(_noiseBuf) / sizeof(_noiseBuf[0]);
+    if (_noiseNext >= size) {
+        _noise.fill(_noiseBuf, size);
+        _noiseNext = 0;
+    }
+    return _noiseBuf[_noiseNext++];
 }
 
 float AgriNodeSimulator::_constrain(float value, float min, float max) {
@@ -163,12 +381,50 @@ AgriculturalNode& AgriNodeSimulator::getNode(uint8_t index) {
     return _nodes[index];
 }
 
+int8_t AgriNodeSimulator::getSlotById(uint16_t nodeId) const {
+    if (nodeId < NODE_ID_BASE || nodeId >= NODE_ID_BASE + NUM_SIMULATED_NODES) return -1;
+    return (int8_t)_slotById[nodeId - NODE_ID_BASE];
+}
+
+AgriculturalNode* AgriNodeSimulator::getNodeById(uint16_t nodeId) {
+    int8_t slot = getSlotById(nodeId);
+    return slot < 0 ? nullptr : &_nodes[slot];
+}
+
+void AgriNodeSimulator::markDirty(const AgriculturalNode& node) {
+    uint16_t block = (uint16_t)(&node - _nodes.data()) / CHECKPOINT_BLOCK_NODES;
+    if (block >= CHECKPOINT_BLOCKS) return;
+    _dirty[block / 32] |= 1UL << (block % 32);
+}
+
+bool AgriNodeSimulator::isBlockDirty(uint16_t block) const {
+    if (block >= CHECKPOINT_BLOCKS) return false;
+    return (_dirty[block / 32] >> (block % 32)) & 1UL;
+}
+
+uint16_t AgriNodeSimulator::dirtyBlockCount() const {
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < sizeof(_dirty) / sizeof(_dirty[0]); i++) {
+        count += __builtin_popcount(_dirty[i]);
+    }
+    return count;
+}
+
+void AgriNodeSimulator::clearDirty() {
+    memset(_dirty, 0, sizeof(_dirty));
+}
+
+void AgriNodeSimulator::reorderNodes() {
+    _sortNodesByHilbert();
+}
+
 void AgriNodeSimulator::printNodeStatus(uint8_t nodeIndex) {
     if (nodeIndex >= NUM_SIMULATED_NODES) return;
 
     const AgriculturalNode& node = _nodes[nodeIndex];
     DEBUG_PRINTLN("----------------------------------------");
-    DEBUG_PRINTF("Nó ID: %d\n", node.nodeId);
+    DEBUG_PRINTF("Nó ID: %d (slot %d)\n", node.nodeId, nodeIndex);
+    DEBUG_PRINTF("  Posição: (%.1f, %.1f) m\n", node.posX, node.posY);
     DEBUG_PRINTF("  Umidade Solo: %.1f%%\n", node.soilMoisture);
     DEBUG_PRINTF("  Temperatura: %.1f°C\n", node.ambientTemp);
 
@@ -186,4 +442,45 @@ void AgriNodeSimulator::printAllNodes() {
         printNodeStatus(i);
     }
     DEBUG_PRINTLN("==========================================\n");
-}
\ No newline at end of file
+}
+const AgriNodeHistory* AgriNodeSimulator::getHistory(uint16_t nodeId) const {
+    if (nodeId < NODE_ID_BASE || nodeId >= NODE_ID_BASE + NUM_SIMULATED_NODES) return nullptr;
+    return &_history[nodeId - NODE_ID_BASE];
+}
+
+struct HistoryExport {
+    Print* out;
+    uint16_t nodeId;
+    uint32_t nowS;            // uptime atual (s)
+    uint32_t nowEpoch;        // 0 = relógio ainda não sincronizado
+};
+
+static void exportHistoryRow(const HistoryReading& r, void* context) {
+    const HistoryExport* ex = (const HistoryExport*)context;
+    uint32_t epoch = ex->nowEpoch ? ex->nowEpoch - (ex->nowS - r.time) : 0;
+    ex->out->printf("%u,%lu,%lu,%.1f,%.1f,%.1f,%d\n", ex->nodeId, (unsigned long)epoch,
+                    (unsigned long)r.time, r.soilMoisture, r.ambientTemp, r.humidity,
+                    r.irrigationStatus);
+}
+
+void AgriNodeSimulator::exportHistory(Print& out) const {
+    HistoryExport ex;
+    ex.out = &out;
+    ex.nowS = millis() / 1000UL;
+    ex.nowEpoch = _currentEpoch();
+
+    out.println("nodeId,epoch,uptime_s,soil,temp,humidity,irrigation");
+    for (uint8_t i = 0; i < NUM_SIMULATED_NODES; i++) {
+        ex.nodeId = NODE_ID_BASE + i;
+        _history[i].forEach(exportHistoryRow, &ex);
+    }
+}
+
+void AgriNodeSimulator::getHistoryStatistics(uint32_t& readings, uint32_t& bytes, uint32_t& dropped) const {
+    readings = bytes = dropped = 0;
+    for (uint8_t i = 0; i < NUM_SIMULATED_NODES; i++) {
+        readings += _history[i].size();
+        bytes += _history[i].bytesUsed();
+        dropped += _history[i].getDropped();
+    }
+}
@@ -0,0 +1,53 @@
+/**
+ * @file AgriNode_Task.cpp
+ * @brief Executor das tarefas cooperativas: retoma só as que estão prontas
+ */
+#include "AgriNode_Task.h"
+
+AgriNodeTaskRunner::AgriNodeTaskRunner() :
+    _slots(),
+    _count(0),
+    _resumes(0)
+{
+}
+
+bool AgriNodeTaskRunner::add(AgriNodeTask* task) {
+    if (task == nullptr || _count >= TASK_MAX_TASKS) return false;
+    _slots[_count].task = task;
+    _slots[_count].status = TASK_WAITING;
+    _count++;
+    return true;
+}
+
+unsigned long AgriNodeTaskRunner::update(unsigned long now) {
+    unsigned long idle = TASK_POLL_MS;
+
+    for (uint8_t i = 0; i < _count; i++) {
+        Slot& slot = _slots[i];
+        if (slot.status == TASK_DONE) continue;
+        // Tarefa dormindo: nem entra no corpo até o prazo
+        if (slot.status == TASK_SLEEPING && (long)(now - slot.task->wakeAt()) < 0) {
+            unsigned long left = slot.task->wakeAt() - now;
+            if (left < idle) idle = left;
+            continue;
+        }
+
+        slot.status = slot.task->step(now);
+        _resumes++;
+
+        if (slot.status == TASK_SLEEPING) {
+            long left = (long)(slot.task->wakeAt() - now);
+            if (left <= 0) idle = 0;
+            else if ((unsigned long)left < idle) idle = (unsigned long)left;
+        }
+    }
+    return idle;
+}
+
+void AgriNodeTaskRunner::getStatistics(uint32_t& resumes, uint8_t& active) {
+    resumes = _resumes;
+    active = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_slots[i].status != TASK_DONE) active++;
+    }
+}
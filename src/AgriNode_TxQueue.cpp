@@ -0,0 +1,102 @@
+/**
+ * @file AgriNode_TxQueue.cpp
+ * @brief Fila de TX coalescente: última leitura vence, alarmes primeiro
+ */
+#include "AgriNode_TxQueue.h"
+
+AgriNodeTxQueue::AgriNodeTxQueue() :
+    _slots(),
+    _count(0),
+    _nextOrder(0),
+    _coalesced(0),
+    _dropped(0),
+    _alarms(0)
+{
+}
+
+bool AgriNodeTxQueue::push(const TxFrame& frame) {
+    if (frame.alarm) {
+        _alarms++;
+    } else {
+        int8_t pending = _findPending(frame.nodeId);
+        if (pending >= 0) {
+            TxFrame& current = _slots[pending].frame;
+            // Reenfileirar um frame que falhou não pode apagar uma leitura mais nova
+            if ((long)(frame.capturedAt - current.capturedAt) < 0) {
+                _dropped++;
+                return false;
+            }
+            current = frame;          // mesma posição na fila, dado mais novo
+            _coalesced++;
+            return true;
+        }
+    }
+
+    int8_t slot = _findFree();
+    if (slot < 0) {
+        // Cheia: sai o frame normal mais antigo; só alarmes = sai o alarme mais antigo
+        slot = _findOldest(false);
+        if (slot < 0) {
+            if (!frame.alarm) {
+                _dropped++;
+                return false;
+            }
+            slot = _findOldest(true);
+        }
+        _slots[slot].used = false;
+        _count--;
+        _dropped++;
+    }
+
+    _slots[slot].frame = frame;
+    _slots[slot].order = _nextOrder++;
+    _slots[slot].used = true;
+    _count++;
+    return true;
+}
+
+bool AgriNodeTxQueue::pop(TxFrame& frame) {
+    int8_t slot = _findOldest(true);
+    if (slot < 0) slot = _findOldest(false);
+    if (slot < 0) return false;
+
+    frame = _slots[slot].frame;
+    _slots[slot].used = false;
+    _count--;
+    return true;
+}
+
+bool AgriNodeTxQueue::hasPending(uint16_t nodeId) const {
+    return _findPending(nodeId) >= 0;
+}
+
+int8_t AgriNodeTxQueue::_findPending(uint16_t nodeId) const {
+    for (uint8_t i = 0; i < TX_QUEUE_CAPACITY; i++) {
+        const Slot& s = _slots[i];
+        if (s.used && !s.frame.alarm && s.frame.nodeId == nodeId) return i;
+    }
+    return -1;
+}
+
+int8_t AgriNodeTxQueue::_findOldest(bool alarm) const {
+    int8_t best = -1;
+    for (uint8_t i = 0; i < TX_QUEUE_CAPACITY; i++) {
+        const Slot& s = _slots[i];
+        if (!s.used || s.frame.alarm != alarm) continue;
+        if (best < 0 || (int32_t)(s.order - _slots[best].order) < 0) best = i;
+    }
+    return best;
+}
+
+int8_t AgriNodeTxQueue::_findFree() const {
+    for (uint8_t i = 0; i < TX_QUEUE_CAPACITY; i++) {
+        if (!_slots[i].used) return i;
+    }
+    return -1;
+}
+
+void AgriNodeTxQueue::getStatistics(uint32_t& coalesced, uint32_t& dropped, uint32_t& alarms) {
+    coalesced = _coalesced;
+    dropped = _dropped;
+    alarms = _alarms;
+}
@@ -0,0 +1,260 @@
+/**
+ * @file AgriNode_Uplink.cpp
+ * @brief Fila de amostras DS18B20 enviada ao Apps Script em janelas periódicas
+ */
+#include "AgriNode_Uplink.h"
+#include <WiFi.h>
+#include <time.h>
+
+// ============ HELPERS ============
+
+String AgriNodeUplink::_urlencode(const String &s) {
+    String out;
+    const char *hex = "0123456789ABCDEF";
+    for (size_t i = 0; i < s.length(); i++) {
+        char c = s[i];
+        if (isalnum((unsigned char)c) || c=='-' || c=='_' || c=='.' || c=='~') {
+            out += c;
+        } else if (c == ' ') {
+            out += "%20";
+        } else {
+            out += '%';
+            out += hex[(c >> 4) & 0x0F];
+            out += hex[c & 0x0F];
+        }
+    }
+    return out;
+}
+
+// Resolvedor do cliente HTTP: consulta o cache DNS sem bloquear
+static int8_t resolveWithCache(const char* host, uint32_t& ip, void* context) {
+    IPAddress addr;
+    DnsResult r = ((AgriNodeDnsCache*)context)->resolve(host, addr);
+    if (r == DNS_RESOLVED) ip = (uint32_t)addr;
+    return r;
+}
+
+AgriNodeUplink::AgriNodeUplink(AgriNodeNetwork& network) :
+    AgriNodeTask("uplink"),
+    _head(0),
+    _count(0),
+    _network(network),
+    _url(),
+    _hop(0),
+    _nextFlushAt(0),
+    _wokeAt(0),
+    _radioSleeping(false),
+    _flushSent(0),
+    _flushFailed(0),
+    _flushMaxAgeMs(0),
+    _samplesSent(0),
+    _samplesFailed(0),
+    _samplesDropped(0)
+{
+}
+
+void AgriNodeUplink::begin() {
+    _guard.begin(millis());
+    _http.setResolver(resolveWithCache, &_dns);
+    _nextFlushAt = millis() + UPLINK_FLUSH_INTERVAL_MS;
+    DEBUG_PRINTF("[UPLINK] Janela de envio a cada %lu s (fila: %d amostras)\n",
+                 UPLINK_FLUSH_INTERVAL_MS / 1000UL, UPLINK_QUEUE_SIZE);
+}
+
+bool AgriNodeUplink::enqueue(float tempC) {
+    bool dropped = false;
+    if (_count == UPLINK_QUEUE_SIZE) {
+        // Fila cheia (backend fora do ar): descarta a amostra mais antiga
+        _head = (_head + 1) % UPLINK_QUEUE_SIZE;
+        _count--;
+        _samplesDropped++;
+        dropped = true;
+    }
+
+    time_t now;
+    time(&now);
+
+    UplinkSample& s = _queue[(_head + _count) % UPLINK_QUEUE_SIZE];
+    s.tempC = tempC;
+    s.epoch = ((unsigned long)now >= TIME_VALID_EPOCH_MIN) ? (uint32_t)now : 0;
+    s.capturedAt = millis();
+    _count++;
+    return !dropped;
+}
+
+TaskStatus AgriNodeUplink::run() {
+    TASK_BEGIN();
+
+    while (true) {
+        // Rádio volta ao modo economia sempre que a rede estiver de pé fora da janela
+        TASK_WAIT_UNTIL(_network.isConnected());
+        if (!_radioSleeping) _setRadioSleep(true);
+
+        TASK_SLEEP_UNTIL(_nextFlushAt - UPLINK_WAKE_LEAD_MS);
+        if (!_network.isConnected()) continue;
+
+        if (_count == 0 || _guard.isOpen(_nextFlushAt)) {
+            // Nada a enviar ou backend em backoff: pula a janela sem acordar
+            // o rádio (nenhum handshake TLS fadado a falhar)
+            _nextFlushAt += UPLINK_FLUSH_INTERVAL_MS;
+            continue;
+        }
+
+        // Acorda o rádio um pouco antes para o AP entregar o buffer pendente (DTIM)
+        _setRadioSleep(false);
+        _wokeAt = taskNow();
+        // Aproveita o rádio acordado para renovar o DNS antes da janela
+        _dns.refreshExpiring();
+        TASK_SLEEP_UNTIL(_nextFlushAt);
+
+        _flushSent = 0;
+        _flushFailed = 0;
+        _flushMaxAgeMs = 0;
+        // Cada etapa da requisição (DNS, conexão, TLS, envio, resposta) avança
+        // uma por passada do loop: backend lento não atrasa o LoRa
+        while (_network.isConnected() && _count > 0 && _guard.allowRequest(millis())) {
+            _startSample();
+            do {
+                TASK_WAIT_UNTIL(_http.poll(millis()));
+            } while (_onResponse());
+            if (!_finishSample(_http.getStatus())) break;
+        }
+        _http.abort();
+        _finishFlush(millis());
+    }
+
+    TASK_END();
+}
+
+void AgriNodeUplink::_startSample() {
+    const UplinkSample& sample = _queue[_head];
+
+    char ts[20];
+    _formatTimestamp(sample, ts, sizeof(ts));
+
+    unsigned long age = millis() - sample.capturedAt;
+    if (age > _flushMaxAgeMs) _flushMaxAgeMs = age;
+
+    String url = String(GOOGLE_SHEETS_URL) +
+                 "?temp=" + String(sample.tempC, 2) +
+                 "&ts=" + _urlencode(ts);
+    strncpy(_url, url.c_str(), sizeof(_url) - 1);
+    _url[sizeof(_url) - 1] = '\0';
+
+    DEBUG_PRINTLN("[SHEETS] Enviando para:");
+    DEBUG_PRINTLN(_url);
+
+    // URL inválida/longa demais já termina aqui com erro em getStatus()
+    _hop = 0;
+    _http.get(_url, millis());
+}
+
+bool AgriNodeUplink::_onResponse() {
+    int httpCode = _http.getStatus();
+    DEBUG_PRINTF("[SHEETS] HTTP code: %d (%s, %lu ms)\n", httpCode, _http.getHost(), _http.getElapsedMs());
+
+    if (httpCode < 0) {
+        DEBUG_PRINTF("[SHEETS] Falha na etapa %s\n", AgriNodeAsyncHttp::stateName(_http.getFailedState()));
+        // IP em cache não conectou (servidor trocou de endereço): força nova consulta
+        if (_http.getFailedState() == ASYNC_HTTP_CONNECTING) _dns.invalidate(_http.getHost());
+        return false;
+    }
+
+    DEBUG_PRINTF("[SHEETS] Resposta (%u de %ld bytes): %s\n",
+                 (unsigned)_http.getBodyLength(), _http.getContentLength(), _http.getBody());
+
+    bool redirect = (httpCode == 301 || httpCode == 302 || httpCode == 303 ||
+                     httpCode == 307 || httpCode == 308);
+    const char* location = _http.getLocation();
+    if (!redirect || location[0] == '\0' || _hop >= UPLINK_MAX_REDIRECTS) return false;
+
+    if (location[0] == '/') {
+        // Location relativo: mantém esquema/host/porta da requisição atual
+        char* origin = strstr(_url, "://");
+        char* originEnd = origin ? strchr(origin + 3, '/') : nullptr;
+        if (originEnd != nullptr) *originEnd = '\0';
+        strncat(_url, location, sizeof(_url) - strlen(_url) - 1);
+    } else {
+        strncpy(_url, location, sizeof(_url) - 1);
+        _url[sizeof(_url) - 1] = '\0';
+    }
+
+    _hop++;
+    _http.get(_url, millis());
+    return true;
+}
+
+bool AgriNodeUplink::_finishSample(int httpCode) {
+    _guard.onResult(httpCode, millis());
+    if (httpCode != 200) {
+        // Mantém na fila; nova tentativa na próxima janela
+        _flushFailed++;
+        _samplesFailed++;
+        return false;
+    }
+
+    _head = (_head + 1) % UPLINK_QUEUE_SIZE;
+    _count--;
+    _flushSent++;
+    _samplesSent++;
+    return true;
+}
+
+void AgriNodeUplink::_finishFlush(unsigned long now) {
+    unsigned long awakeMs = now - _wokeAt;
+    // Estimativa: corrente média do rádio ativo x tempo acordado x 3.3 V
+    float energyMj = awakeMs * UPLINK_WIFI_ACTIVE_MA * 3.3f / 1000.0f;
+
+    DEBUG_PRINTF("[UPLINK] Janela: %d enviadas, %d falhas, %d pendentes | acordado %lu ms | "
+                 "latência máx %lu ms | ~%.1f mJ | breaker %s\n",
+                 _flushSent, _flushFailed, _count, awakeMs, _flushMaxAgeMs, energyMj,
+                 _guard.getStateName());
+
+    _setRadioSleep(true);
+
+    // Realinha a grade de janelas (evita rajadas após longos períodos offline)
+    do {
+        _nextFlushAt += UPLINK_FLUSH_INTERVAL_MS;
+    } while ((long)(now - _nextFlushAt) >= 0);
+}
+
+void AgriNodeUplink::_setRadioSleep(bool sleep) {
+    // MAX_MODEM: o rádio só acorda a cada listen interval; reduz consumo e
+    // a interferência de RF com o SX1276 ao lado
+    WiFi.setSleep(sleep ? WIFI_PS_MAX_MODEM : WIFI_PS_NONE);
+    _radioSleeping = sleep;
+}
+
+void AgriNodeUplink::_formatTimestamp(const UplinkSample& sample, char* buf, size_t len) {
+    time_t ts = (time_t)sample.epoch;
+    if (ts == 0) {
+        time_t now;
+        time(&now);
+        if ((unsigned long)now >= TIME_VALID_EPOCH_MIN) {
+            // Amostra anterior ao NTP: reconstrói pelo tempo decorrido
+            ts = now - (time_t)((millis() - sample.capturedAt) / 1000UL);
+        }
+    }
+
+    if (ts == 0) {
+        DEBUG_PRINTLN("[TIME] Relógio não sincronizado, usando epoch 0");
+        snprintf(buf, len, "1970-01-01 00:00:00");
+        return;
+    }
+
+    struct tm timeinfo;
+    localtime_r(&ts, &timeinfo);
+    snprintf(buf, len, "%04d-%02d-%02d %02d:%02d:%02d",
+             timeinfo.tm_year + 1900,
+             timeinfo.tm_mon + 1,
+             timeinfo.tm_mday,
+             timeinfo.tm_hour,
+             timeinfo.tm_min,
+             timeinfo.tm_sec);
+}
+
+void AgriNodeUplink::getStatistics(uint32_t& sent, uint32_t& failed, uint32_t& dropped) {
+    sent = _samplesSent;
+    failed = _samplesFailed;
+    dropped = _samplesDropped;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file AgriNode_UplinkGuard.cpp
+ * @brief Limita a taxa de requisições ao Apps Script e recua quando o backend falha
+ */
+#include "AgriNode_UplinkGuard.h"
+
+AgriNodeUplinkGuard::AgriNodeUplinkGuard() :
+    _tokens(UPLINK_BUCKET_CAPACITY),
+    _lastRefill(0),
+    _state(BREAKER_CLOSED),
+    _consecutiveFailures(0),
+    _backoffExp(0),
+    _openUntil(0),
+    _throttled(0),
+    _rejected(0),
+    _trips(0)
+{
+}
+
+void AgriNodeUplinkGuard::begin(unsigned long now) {
+    _tokens = UPLINK_BUCKET_CAPACITY;
+    _lastRefill = now;
+}
+
+void AgriNodeUplinkGuard::_refill(unsigned long now) {
+    unsigned long elapsed = now - _lastRefill;
+    _lastRefill = now;
+    _tokens += elapsed * (UPLINK_BUCKET_REFILL_PER_MIN / 60000.0f);
+    if (_tokens > UPLINK_BUCKET_CAPACITY) _tokens = UPLINK_BUCKET_CAPACITY;
+}
+
+bool AgriNodeUplinkGuard::isOpen(unsigned long now) const {
+    return _state == BREAKER_OPEN && (long)(now - _openUntil) < 0;
+}
+
+bool AgriNodeUplinkGuard::allowRequest(unsigned long now) {
+    if (_state == BREAKER_OPEN) {
+        if ((long)(now - _openUntil) < 0) {
+            _rejected++;
+            return false;
+        }
+        // Backoff expirou: deixa passar uma única requisição de teste
+        _state = BREAKER_HALF_OPEN;
+        DEBUG_PRINTLN("[GUARD] Breaker HALF-OPEN (requisição de teste)");
+    }
+
+    _refill(now);
+    if (_tokens < 1.0f) {
+        _throttled++;
+        return false;
+    }
+    _tokens -= 1.0f;
+    return true;
+}
+
+void AgriNodeUplinkGuard::onResult(int httpCode, unsigned long now) {
+    if (httpCode >= 200 && httpCode < 400) {
+        if (_state != BREAKER_CLOSED) {
+            DEBUG_PRINTLN("[GUARD] Backend respondeu, breaker FECHADO");
+        }
+        _state = BREAKER_CLOSED;
+        _consecutiveFailures = 0;
+        _backoffExp = 0;
+        return;
+    }
+
+    if (httpCode == 429) {
+        // Cota do Apps Script: recua imediatamente e por mais tempo, e zera o balde
+        _tokens = 0;
+        _trip(now, UPLINK_BACKOFF_QUOTA_MS, httpCode);
+        return;
+    }
+
+    // 5xx, outros 4xx e erros de transporte (<0: DNS, TLS, timeout)
+    _consecutiveFailures++;
+    if (_state == BREAKER_HALF_OPEN || _consecutiveFailures >= UPLINK_BREAKER_THRESHOLD) {
+        _trip(now, UPLINK_BACKOFF_BASE_MS, httpCode);
+    }
+}
+
+void AgriNodeUplinkGuard::_trip(unsigned long now, unsigned long baseMs, int httpCode) {
+    unsigned long backoff = baseMs << _backoffExp;
+    if (backoff > UPLINK_BACKOFF_MAX_MS || backoff < baseMs) backoff = UPLINK_BACKOFF_MAX_MS;
+    if (_backoffExp < 16) _backoffExp++;
+
+    // Jitter de até 25% para não sincronizar com outros gateways
+    backoff += random(0, backoff / 4 + 1);
+
+    _state = BREAKER_OPEN;
+    _openUntil = now + backoff;
+    _consecutiveFailures = 0;
+    _trips++;
+
+    DEBUG_PRINTF("[GUARD] Breaker ABERTO (HTTP %d): nova tentativa em %lu s\n",
+                 httpCode, backoff / 1000UL);
+}
+
+const char* AgriNodeUplinkGuard::getStateName() const {
+    switch (_state) {
+        case BREAKER_CLOSED:    return "FECHADO";
+        case BREAKER_OPEN:      return "ABERTO";
+        case BREAKER_HALF_OPEN: return "HALF-OPEN";
+        default:                return "?";
+    }
+}
+
+void AgriNodeUplinkGuard::getStatistics(uint32_t& throttled, uint32_t& rejected, uint32_t& trips) {
+    throttled = _throttled;
+    rejected = _rejected;
+    trips = _trips;
+}
@@ -4,246 +4,181 @@
  */
 
 #include <Arduino.h>
-#include <WiFi.h>
 #include "time.h"
 
-#include <OneWire.h>
-#include <DallasTemperature.h>
-#include <HTTPClient.h>
-
 #include "AgriNode_Config.h"
 #include "AgriNode_Simulator.h"
 #include "AgriNode_LoRaTx.h"
+#include "AgriNode_Network.h"
+#include "AgriNode_Uplink.h"
+#include "AgriNode_Task.h"
+#include "AgriNode_SensorScheduler.h"
+#include "AgriNode_Ds18b20.h"
+#include "AgriNode_MemoryMonitor.h"
+#include "AgriNode_BootLog.h"
+#include "AgriNode_EventLog.h"
+#include "AgriNode_Checkpoint.h"
+#include "AgriNode_ReadingStore.h"
+#if SHT3X_ENABLED
+#include "AgriNode_Sht3x.h"
+#endif
+#if AGRINODE_PROFILER
+#include "AgriNode_Profiler.h"
+#endif
+#if AGRINODE_BENCHMARK
+#include "AgriNode_Benchmark.h"
+#endif
 
 AgriNodeSimulator simulator;
-AgriNodeLoRaTx loraTx;
+AgriNodeLoRaTx loraTx(simulator);
+AgriNodeNetwork network;
+AgriNodeUplink uplink(network);
+// Transições de irrigação em LittleFS (sobrevivem ao reboot)
+AgriNodeEventLog eventLog;
+// Estado dos nós: base + deltas só dos blocos alterados
+AgriNodeCheckpoint nodeCheckpoint(simulator);
+// Histórico de dias na partição "readings" (nós + DS18B20), consultável por epoch
+AgriNodeReadingStore readingStore;
+static unsigned long lastStoredSample = 0;
 
 unsigned long bootTime = 0;
-unsigned long lastStatsTime = 0;
 const unsigned long STATS_INTERVAL = 60000;
 
-// --- ESTADO WiFi (apenas para debug) ---
-static bool wifiConnecting  = false;   // tentando conectar
-static unsigned long wifiEventCount = 0;
-
-// --- DS18B20 ---
-OneWire oneWire(DS18B20_PIN);
-DallasTemperature ds18b20(&oneWire);
-unsigned long lastSensorRead = 0;
-
-// ============ HELPERS ============
+void printStatistics();
 
-String urlencode(const String &s) {
-    String out;
-    const char *hex = "0123456789ABCDEF";
-    for (size_t i = 0; i < s.length(); i++) {
-        char c = s[i];
-        if (isalnum((unsigned char)c) || c=='-' || c=='_' || c=='.' || c=='~') {
-            out += c;
-        } else if (c == ' ') {
-            out += "%20";
-        } else {
-            out += '%';
-            out += hex[(c >> 4) & 0x0F];
-            out += hex[c & 0x0F];
+// Estatísticas periódicas como tarefa (sem comparar millis() no loop)
+class StatsTask : public AgriNodeTask {
+public:
+    StatsTask() : AgriNodeTask("stats") {}
+protected:
+    TaskStatus run() override {
+        TASK_BEGIN();
+        while (true) {
+            TASK_SLEEP(STATS_INTERVAL);
+            printStatistics();
         }
+        TASK_END();
     }
-    return out;
-}
-
-bool readTemperatureDS18B20(float &tempC) {
-    ds18b20.requestTemperatures();
-    delay(800); // conversão 12-bit ~750ms [web:25][web:28]
-
-    float t = ds18b20.getTempCByIndex(0);
-    if (t == DEVICE_DISCONNECTED_C || t < -50.0 || t > 125.0) {
-        DEBUG_PRINTLN("[DS18B20] Leitura inválida");
-        return false;
-    }
-    tempC = t;
-    DEBUG_PRINTF("[DS18B20] Temperatura: %.2f °C\n", tempC);
-    return true;
-}
-
-String getTimestampString() {
-    struct tm timeinfo;
-    if (!getLocalTime(&timeinfo, 1000)) {
-        DEBUG_PRINTLN("[TIME] getLocalTime falhou, usando epoch 0");
-        return "1970-01-01 00:00:00";
-    }
-
-    char buf[20];
-    snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d",
-             timeinfo.tm_year + 1900,
-             timeinfo.tm_mon + 1,
-             timeinfo.tm_mday,
-             timeinfo.tm_hour,
-             timeinfo.tm_min,
-             timeinfo.tm_sec);
-    return String(buf);
-}
-
-#include <WiFiClientSecure.h>
-
-bool sendToGoogleSheets(float tempC, const String &timestamp ) {
-    if (WiFi.status() != WL_CONNECTED) {
-        DEBUG_PRINTLN("[SHEETS] WiFi OFFLINE, não enviando");
-        return false;
+};
+
+StatsTask statsTask;
+AgriNodeMemoryMonitor memoryMonitor;
+AgriNodeTaskRunner tasks;
+
+#if AGRINODE_PROFILER
+AgriNodeProfiler profiler;
+
+// Uma janela de amostras por dump: cada bloco BEGIN/END cobre só o último intervalo
+class ProfilerTask : public AgriNodeTask {
+public:
+    ProfilerTask() : AgriNodeTask("profiler") {}
+protected:
+    TaskStatus run() override {
+        TASK_BEGIN();
+        while (true) {
+            TASK_SLEEP(PROFILER_DUMP_INTERVAL_MS);
+            profiler.dump(Serial);
+            profiler.reset();
+        }
+        TASK_END();
     }
+};
 
-    String url = String(GOOGLE_SHEETS_URL) +
-                 "?temp=" + String(tempC, 2) +
-                 "&ts=" + urlencode(timestamp);
-
-    DEBUG_PRINTLN("[SHEETS] Enviando para:");
-    DEBUG_PRINTLN(url);
-
-    WiFiClientSecure client;
-    client.setInsecure();               // NÃO verifica certificado (simplifica HTTPS)[web:60]
-    client.setTimeout(15000);           // 15 s de timeout, um pouco maior
-
-    HTTPClient http;
-    if (!http.begin(client, url)) {     // usa o client seguro
-        DEBUG_PRINTLN("[SHEETS] http.begin() falhou");
-        return false;
-    }
+ProfilerTask profilerTask;
+#endif
 
-    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
-    int httpCode = http.GET();
+#if AGRINODE_BENCHMARK
+AgriNodeBenchmark benchmark(simulator, loraTx, uplink);
+bool benchLoraReady = false;
 
-    DEBUG_PRINTF("[SHEETS] HTTP code: %d\n", httpCode);
-    if (httpCode > 0) {
-        String payload = http.getString();
-        DEBUG_PRINTF("[SHEETS] Resposta: %s\n", payload.c_str());
-    }
-    http.end();
-    return httpCode == 200;
+// Modo benchmark: sobem só simulador e rádio (sem WiFi, sensores ou tarefas)
+void benchmarkSetup() {
+    simulator.begin();
+    benchLoraReady = loraTx.begin();
+    benchmark.run(Serial, benchLoraReady);
+    DEBUG_PRINTLN("[BENCH] Envie qualquer caractere pela serial para repetir");
 }
 
-// ============ CALLBACK DE EVENTOS ============
-
-void WiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info) {
-    wifiEventCount++;
-    DEBUG_PRINTF("\n[WiFiEvent #%lu] ", wifiEventCount);
-
-    switch (event) {
-        case ARDUINO_EVENT_WIFI_READY:
-            DEBUG_PRINTLN("WiFi READY");
-            break;
-
-        case ARDUINO_EVENT_WIFI_STA_START:
-            DEBUG_PRINTLN("STA START");
-            wifiConnecting = true;
-            break;
-
-        case ARDUINO_EVENT_WIFI_STA_CONNECTED:
-            DEBUG_PRINTLN("STA CONNECTED ao AP");
-            break;
-
-        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
-            DEBUG_PRINTLN("STA DISCONNECTED");
-            DEBUG_PRINTF("  Razão: %d - ", info.wifi_sta_disconnected.reason);
-            switch (info.wifi_sta_disconnected.reason) {
-                case 2:   DEBUG_PRINTLN("AUTH_EXPIRE"); break;
-                case 6:   DEBUG_PRINTLN("NOT_AUTHED");  break;
-                case 15:  DEBUG_PRINTLN("4WAY_HANDSHAKE_TIMEOUT"); break;
-                case 39:  DEBUG_PRINTLN("TIMEOUT");     break;
-                case 201: DEBUG_PRINTLN("NO_AP_FOUND"); break;
-                default:  DEBUG_PRINTLN("OUTRA");       break;
-            }
-            break;
-
-        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
-            DEBUG_PRINTLN("STA GOT_IP");
-            DEBUG_PRINTF("  IP: %s\n", WiFi.localIP().toString().c_str());
-            wifiConnecting = false;
-            break;
-
-        default:
-            DEBUG_PRINTF("Evento genérico: %d\n", event);
-            break;
+void benchmarkLoop() {
+    if (Serial.available() > 0) {
+        while (Serial.available() > 0) Serial.read();
+        benchmark.run(Serial, benchLoraReady);
     }
+    delay(50);
 }
+#endif
+
+// --- BOOT: fases e dependências entre subsistemas ---
+// LoRa e simulador sobem sem WiFi; o uplink depende de WiFi e os timestamps
+// dos nós são preenchidos quando o NTP sincroniza.
+enum BootReady : uint8_t {
+    BOOT_SIM  = 1 << 0,
+    BOOT_LORA = 1 << 1,
+    BOOT_WIFI = 1 << 2,
+    BOOT_NTP  = 1 << 3,
+    BOOT_TX   = 1 << 4     // primeiro frame LoRa enviado
+};
+
+// Tempos em µs de cada fase; últimos boots guardados na RTC RAM
+AgriNodeBootLog bootLog;
+static uint8_t bootReady = 0;
+
+// --- SENSORES REAIS ---
+OneWire oneWire(DS18B20_PIN);
+DallasTemperature dallas(&oneWire);
+AgriNodeDs18b20 tempSensor(dallas, 0, SENSOR_ID_GATEWAY_TEMP);
+#if SHT3X_ENABLED
+AgriNodeSht3x airSensor(Wire, SHT3X_ADDRESS, SENSOR_ID_AIR);
+#endif
+AgriNodeSensorScheduler sensors;
 
-// ============ WIFI: FLUXO SIMPLES E LIMPO ============
-
-void setupNetwork() {
-    DEBUG_PRINTLN("\n========================================");
-    DEBUG_PRINTF("[NET] Conectando WiFi: '%s'\n", WIFI_SSID_NAME);
-    DEBUG_PRINTLN("========================================");
-
-    wifiConnecting = false;
-    digitalWrite(LED_WIFI, LOW);
-
-    WiFi.disconnect(true, true);
-    delay(500);
-
-    WiFi.onEvent(WiFiEvent);
-    WiFi.mode(WIFI_STA);
-    delay(200);
-
-    WiFi.setTxPower(WIFI_POWER_8_5dBm);
-
-    DEBUG_PRINTLN("[NET] WiFi.begin()...");
-    WiFi.begin(WIFI_SSID_NAME, WIFI_PASSWORD);
-    wifiConnecting = true;
-
-    unsigned long start = millis();
-    int lastStatus = WL_IDLE_STATUS;
-
-    while ((WiFi.status() != WL_CONNECTED) && (millis() - start < 25000)) {
-        delay(100);
-
-        if (wifiConnecting && WiFi.status() != WL_CONNECTED) {
-            digitalWrite(LED_WIFI, (millis() / 100) % 2 ? HIGH : LOW);
-        }
+// ============ HELPERS ============
 
-        int st = WiFi.status();
-        if (st != lastStatus) {
-            lastStatus = st;
-            DEBUG_PRINTF("[NET] Status: %d ", st);
-            switch (st) {
-                case WL_IDLE_STATUS:      DEBUG_PRINTLN("(IDLE)");          break;
-                case WL_NO_SSID_AVAIL:    DEBUG_PRINTLN("(NO_SSID)");       break;
-                case WL_SCAN_COMPLETED:   DEBUG_PRINTLN("(SCAN_DONE)");     break;
-                case WL_CONNECTED:        DEBUG_PRINTLN("(CONNECTED)");     break;
-                case WL_CONNECT_FAILED:   DEBUG_PRINTLN("(CONNECT_FAILED)");break;
-                case WL_CONNECTION_LOST:  DEBUG_PRINTLN("(CONNECTION_LOST)");break;
-                case WL_DISCONNECTED:     DEBUG_PRINTLN("(DISCONNECTED)");  break;
-                default:                  DEBUG_PRINTLN("(UNKNOWN)");       break;
-            }
+void onSensorReading(const SensorReading& r, void* context) {
+    if (r.sensorId == SENSOR_ID_GATEWAY_TEMP && r.kind == SENSOR_TEMPERATURE) {
+        // DS18B20 do gateway -> fila do uplink (enviada em janelas para o Google Sheets)
+        uplink.enqueue(r.value);
+        if (lastStoredSample == 0 || r.takenAt - lastStoredSample >= STORE_SENSOR_INTERVAL_MS) {
+            readingStore.appendSample(r.sensorId, r.value);
+            lastStoredSample = r.takenAt;
         }
-
-        if (WiFi.status() == WL_CONNECTED) break;
+#if SIM_AMBIENT_FROM_DS18B20
+        simulator.setAmbientBaseline(r.value);
+#endif
+        return;
     }
+    DEBUG_PRINTF("[SENSOR %d] tipo %d = %.2f\n", r.sensorId, r.kind, r.value);
+}
 
-    if (WiFi.status() == WL_CONNECTED) {
-        digitalWrite(LED_WIFI, HIGH);
-        wifiConnecting = false;
-
-        DEBUG_PRINTLN("\n✅ WiFi CONECTADO!");
-        DEBUG_PRINTF("   IP: %s\n", WiFi.localIP().toString().c_str());
-        DEBUG_PRINTF("   RSSI: %d dBm | Canal: %d\n", WiFi.RSSI(), WiFi.channel());
-        DEBUG_PRINTF("   Gateway: %s\n", WiFi.gatewayIP().toString().c_str());
-
-        DEBUG_PRINTLN("[NET] Sincronizando NTP...");
-        configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER_1, NTP_SERVER_2);
-        struct tm timeinfo;
-        if (getLocalTime(&timeinfo, 15000)) {
-            DEBUG_PRINTLN("✅ NTP OK");
-            DEBUG_PRINTF("   Hora: %02d:%02d:%02d\n",
-                         timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
-        } else {
-            DEBUG_PRINTLN("⚠️  NTP timeout (mas WiFi está ok)");
-        }
-    } else {
-        wifiConnecting = false;
-        digitalWrite(LED_WIFI, LOW);
+void onNodeTransition(const AgriculturalNode& node, IrrigationStatus from, void* context) {
+    eventLog.record(node.nodeId, from, node.irrigationStatus, node.soilMoisture);
+}
 
-        DEBUG_PRINTLN("\n❌ WiFi NÃO conectou dentro do timeout");
+void applyEventLogState() {
+    for (uint8_t i = 0; i < NUM_SIMULATED_NODES; i++) {
+        AgriculturalNode& node = simulator.getNode(i);
+        const NodeEventState* state = eventLog.getNodeState(node.nodeId);
+        if (state == nullptr || node.irrigationStatus == state->state) continue;
+        DEBUG_PRINTF("[EVT] Node %d: status %d do checkpoint -> %d do log\n",
+                     node.nodeId, node.irrigationStatus, state->state);
+        node.irrigationStatus = (IrrigationStatus)state->state;
+        node.needsIrrigation = (node.irrigationStatus == IRRIGATION_ON);
+        simulator.markDirty(node);
     }
+}
 
-    DEBUG_PRINTLN("========================================\n");
+void onNodeUpdate(const AgriculturalNode& node, void* context) {
+    readingStore.appendNode(node);
+}
+
+void markBootReady(BootReady flag, BootPhaseId phase) {
+    if (bootReady & flag) return;
+    bootReady |= flag;
+    bootLog.mark(phase);
+    // Mesmo valor gravado no registro (64 bits saturado, não micros())
+    uint32_t us = bootLog.current().phaseUs[phase];
+    DEBUG_PRINTF("[BOOT] %-12s +%lu.%03lu ms\n", AgriNodeBootLog::phaseName(phase),
+                 (unsigned long)(us / 1000UL), (unsigned long)(us % 1000UL));
 }
 
 // ============ RESTANTE (LEDs, Simulador, LoRa) ============
@@ -281,54 +216,91 @@ void printStatistics() {
         float rate = 100.0f * sent / (sent + failed);
         DEBUG_PRINTF("  Sucesso:     %.1f%%\n", rate);
     }
-    DEBUG_PRINTF("  WiFi:        %s\n", WiFi.status() == WL_CONNECTED ? "ONLINE" : "OFFLINE");
-    DEBUG_PRINTF("  Heap livre:  %lu bytes\n", ESP.getFreeHeap());
+    uint8_t txPending; uint32_t txCoalesced, txDropped, txAlarms;
+    loraTx.getQueueStatistics(txPending, txCoalesced, txDropped, txAlarms);
+    DEBUG_PRINTF("  Fila TX:     %d | Coalescidas: %lu | Descartadas: %lu | Alarmes: %lu\n",
+                 txPending, txCoalesced, txDropped, txAlarms);
+    DEBUG_PRINTF("  Carga TX:    %d%% | Simulador: %s\n",
+                 loraTx.getTxLoad(), AgriNodeSimulator::loadModeName(simulator.getLoadMode()));
+    DEBUG_PRINTF("  WiFi:        %s\n", network.isConnected() ? "ONLINE" : "OFFLINE");
+    uint32_t upSent, upFailed, upDropped;
+    uplink.getStatistics(upSent, upFailed, upDropped);
+    DEBUG_PRINTF("  Sheets:      %lu | Falhas: %lu | Descartes: %lu | Fila: %d\n",
+                 upSent, upFailed, upDropped, uplink.getPending());
+    uint32_t throttled, rejected, trips;
+    uplink.getGuard().getStatistics(throttled, rejected, trips);
+    DEBUG_PRINTF("  Breaker:     %s | Limitadas: %lu | Rejeitadas: %lu | Aberturas: %lu\n",
+                 uplink.getGuard().getStateName(), throttled, rejected, trips);
+    uint32_t dnsHits, dnsMisses, dnsStale;
+    uplink.getDnsCache().getStatistics(dnsHits, dnsMisses, dnsStale);
+    DEBUG_PRINTF("  DNS cache:   %lu hits | %lu consultas | %lu IP antigo\n",
+                 dnsHits, dnsMisses, dnsStale);
+    uint32_t sensorReads, sensorErrors, sensorDeferred;
+    sensors.getStatistics(sensorReads, sensorErrors, sensorDeferred);
+    DEBUG_PRINTF("  Sensores:    %lu leituras | %lu erros | %lu adiadas (LoRa)\n",
+                 sensorReads, sensorErrors, sensorDeferred);
+    uint32_t evLogged, evBytes, evCompactions;
+    eventLog.getStatistics(evLogged, evBytes, evCompactions);
+    DEBUG_PRINTF("  Eventos:     %lu gravados | log %lu bytes | %lu compactações | seq %lu\n",
+                 evLogged, evBytes, evCompactions, eventLog.getLastSeq());
+    uint32_t histReadings, histBytes, histDropped;
+    simulator.getHistoryStatistics(histReadings, histBytes, histDropped);
+    DEBUG_PRINTF("  Histórico:   %lu leituras | %lu bytes (%.1f B/leitura) | %lu descartadas\n",
+                 histReadings, histBytes, histReadings ? (float)histBytes / histReadings : 0.0f,
+                 histDropped);
+    uint32_t ckDeltas, ckBlocks, ckBytes, ckMerges;
+    nodeCheckpoint.getStatistics(ckDeltas, ckBlocks, ckBytes, ckMerges);
+    DEBUG_PRINTF("  Checkpoint:  %lu deltas | %lu blocos | %lu bytes | cadeia %d | %lu fusões\n",
+                 ckDeltas, ckBlocks, ckBytes, nodeCheckpoint.getChainLength(), ckMerges);
+    uint32_t stStored, stDropped, stCrc; uint16_t stSegments;
+    readingStore.getStatistics(stStored, stSegments, stDropped, stCrc);
+    DEBUG_PRINTF("  Flash:       %lu registros | %d/%d segmentos | %lu reciclados | %lu CRC\n",
+                 stStored, stSegments, readingStore.getSegmentCount(), stDropped, stCrc);
+    uint32_t taskResumes; uint8_t tasksActive;
+    tasks.getStatistics(taskResumes, tasksActive);
+    DEBUG_PRINTF("  Tarefas:     %d ativas | %lu retomadas\n", tasksActive, taskResumes);
+    memoryMonitor.printReport();
     DEBUG_PRINTLN("========================================================\n");
 }
 
 void setup() {
+    bootLog.begin();
     Serial.begin(DEBUG_BAUDRATE);
-    delay(1500);
+    // Espera limitada pelo USB CDC em vez do delay fixo de 1500ms
+    while (!Serial && millis() < BOOT_SERIAL_WAIT_MS) { delay(10); }
+    bootTime = millis();
+    bootLog.mark(BOOT_PHASE_SERIAL);
 
-    // LEDs
+#if AGRINODE_BENCHMARK
+    benchmarkSetup();
+    return;
+#endif
+
+    // LEDs: teste visual com todos acesos até o LoRa subir (sem delays)
     pinMode(LED_WIFI,   OUTPUT);
     pinMode(LED_TX,     OUTPUT);
     pinMode(LED_ERROR,  OUTPUT);
     pinMode(LED_SIM,    OUTPUT);
     pinMode(LED_STATUS, OUTPUT);
 
-    digitalWrite(LED_WIFI,   LOW);
-    digitalWrite(LED_TX,     LOW);
-    digitalWrite(LED_ERROR,  LOW);
-    digitalWrite(LED_SIM,    LOW);
-    digitalWrite(LED_STATUS, HIGH);   // STATUS começa ACESO
-
-    // Teste rápido visual dos LEDs
-    digitalWrite(LED_WIFI, HIGH);   delay(200); digitalWrite(LED_WIFI, LOW);
-    digitalWrite(LED_TX,   HIGH);   delay(200); digitalWrite(LED_TX,   LOW);
-    digitalWrite(LED_ERROR,HIGH);   delay(200); digitalWrite(LED_ERROR,LOW);
-    digitalWrite(LED_SIM,  HIGH);   delay(200); digitalWrite(LED_SIM,  LOW);
-    digitalWrite(LED_STATUS,HIGH);  delay(200); digitalWrite(LED_STATUS,LOW);
+    digitalWrite(LED_WIFI,   HIGH);
+    digitalWrite(LED_TX,     HIGH);
+    digitalWrite(LED_ERROR,  HIGH);
+    digitalWrite(LED_SIM,    HIGH);
     digitalWrite(LED_STATUS, HIGH);
+    bootLog.mark(BOOT_PHASE_LEDS);
 
-    // DS18B20
-    ds18b20.begin();
-    DEBUG_PRINTLN("[DS18B20] Inicializado");
-
-    bootTime = millis();
     printSystemInfo();
 
-    // 1) WiFi
-    setupNetwork();
-
-    // 2) Simulador
+    // 1) Simulador (não depende de WiFi; timestamps preenchidos após NTP)
     if (!simulator.begin()) {
         DEBUG_PRINTLN("FATAL: Simulador falhou");
         digitalWrite(LED_ERROR, HIGH);
         while (true) { delay(100); }
     }
+    markBootReady(BOOT_SIM, BOOT_PHASE_SIMULATOR);
 
-    // 3) LoRa
+    // 2) LoRa (caminho crítico do primeiro frame)
     if (!loraTx.begin()) {
         DEBUG_PRINTLN("FATAL: LoRa falhou");
         digitalWrite(LED_ERROR, HIGH);
@@ -337,43 +309,115 @@ void setup() {
             digitalWrite(LED_STATUS, LOW);  delay(200);
         }
     }
-
-    DEBUG_PRINTLN("🚀 SISTEMA ONLINE (LoRa + Simulador + WiFi + DS18B20)");
-    lastStatsTime = millis();
+    markBootReady(BOOT_LORA, BOOT_PHASE_LORA);
+
+    digitalWrite(LED_WIFI,  LOW);
+    digitalWrite(LED_TX,    LOW);
+    digitalWrite(LED_ERROR, LOW);
+    digitalWrite(LED_SIM,   LOW);
+
+    // 3) DS18B20
+    dallas.begin();
+    sensors.add(&tempSensor, DS18B20_READ_INTERVAL_MS);
+#if SHT3X_ENABLED
+    Wire.begin(SHT3X_SDA_PIN, SHT3X_SCL_PIN);
+    sensors.add(&airSensor, SHT3X_READ_INTERVAL_MS);
+#endif
+    sensors.onReading(onSensorReading, nullptr);
+    DEBUG_PRINTF("[SENSOR] %d de %d drivers ativos\n", sensors.begin(millis()), sensors.getDriverCount());
+    bootLog.mark(BOOT_PHASE_DS18B20);
+
+    // Log de eventos: snapshot + log reaplicados antes do primeiro tick do simulador
+    if (eventLog.begin()) {
+        eventLog.printRecoveredState();
+        simulator.onTransition(onNodeTransition, nullptr);
+    }
+    // Checkpoint: restaura os nós antes do primeiro tick (tarefas ainda paradas)
+    nodeCheckpoint.begin();
+    // O log é mais novo que o checkpoint (até CHECKPOINT_INTERVAL_MS): o status
+    // de irrigação vem dele, para o próximo evento continuar a cadeia
+    applyEventLogState();
+    if (readingStore.begin()) simulator.onUpdate(onNodeUpdate, nullptr);
+
+    // 4) WiFi + NTP em background (concluídos no loop)
+    network.begin();
+    uplink.begin();
+    bootLog.mark(BOOT_PHASE_WIFI_START);
+
+    // 5) Tarefas cooperativas: todas dividem a pilha do loop()
+    tasks.add(&loraTx);
+    tasks.add(&simulator);
+    tasks.add(&uplink);
+    tasks.add(&statsTask);
+    tasks.add(&memoryMonitor);
+    tasks.add(&nodeCheckpoint);
+    tasks.add(&readingStore);
+    memoryMonitor.begin();
+#if AGRINODE_PROFILER
+    tasks.add(&profilerTask);
+    profiler.begin();
+#endif
+
+    bootLog.mark(BOOT_PHASE_SETUP_DONE);
+    bootLog.printReport();
+    bootLog.printHistory();
+    DEBUG_PRINTLN("🚀 SISTEMA ONLINE (LoRa + Simulador + DS18B20; WiFi em background)");
 }
 
-void loop() {
-    unsigned long now = millis();
-
-    // LED_STATUS fixo ligado
-    digitalWrite(LED_STATUS, HIGH);
-
-    // LED WiFi: HIGH se conectado, LOW se não
-    if (WiFi.status() == WL_CONNECTED) {
-        digitalWrite(LED_WIFI, HIGH);
-    } else if (!wifiConnecting) {
-        digitalWrite(LED_WIFI, LOW);
+void updateBootDependencies() {
+    if (bootReady & BOOT_TX) {
+        if ((bootReady & BOOT_WIFI) && (bootReady & BOOT_NTP)) return;
+    } else {
+        uint32_t sent, failed;
+        loraTx.getStatistics(sent, failed);
+        if (sent > 0) markBootReady(BOOT_TX, BOOT_PHASE_FIRST_TX);
     }
 
-    simulator.update();
-    loraTx.update(simulator);
+    if (network.isConnected()) markBootReady(BOOT_WIFI, BOOT_PHASE_WIFI);
 
-    // Estatísticas periódicas
-    if (now - lastStatsTime > STATS_INTERVAL) {
-        lastStatsTime = now;
-        printStatistics();
+    if (!(bootReady & BOOT_NTP) && network.isTimeSynced()) {
+        markBootReady(BOOT_NTP, BOOT_PHASE_NTP);
+        simulator.backfillTimestamps();
     }
 
-    // Leitura periódica DS18B20 + envio para Google Sheets
-    if (now - lastSensorRead >= DS18B20_READ_INTERVAL_MS) {
-        lastSensorRead = now;
+    // Boot completo: histórico com este boot já fechado (1º TX, WiFi e NTP)
+    if ((bootReady & BOOT_TX) && (bootReady & BOOT_WIFI) && (bootReady & BOOT_NTP)) {
+        bootLog.printReport();
+        bootLog.printHistory();
+    }
+}
 
-        float tempC;
-        if (readTemperatureDS18B20(tempC)) {
-            String ts = getTimestampString();
-            sendToGoogleSheets(tempC, ts); // padrão Apps Script para gravar em Sheets [web:24][web:31]
+void loop() {
+#if AGRINODE_BENCHMARK
+    benchmarkLoop();
+    return;
+#endif
+
+    // LED_STATUS fica ligado desde o setup(); só a tarefa do LoRa o pisca
+    // WiFi/NTP progridem aqui (LED_WIFI controlado pela rede)
+    network.update();
+    updateBootDependencies();
+
+    // LoRa, simulador, uplink e estatísticas retomam só quando têm algo a fazer
+    unsigned long idleMs = tasks.update(millis());
+
+    // Contrapressão: o simulador desacelera quando o rádio não dá vazão
+    simulator.setTxLoad(loraTx.getTxLoad());
+
+    // Sensores reais: conversões intercaladas, encaixadas na folga do LoRa
+    sensors.update(millis(), loraTx.msUntilNextTx());
+
+    // Console: 'h' = histórico comprimido em RAM; 'r' = últimas 24 h da flash (CSV)
+    if (Serial.available() > 0) {
+        int cmd = Serial.read();
+        if (cmd == 'h') simulator.exportHistory(Serial);
+        if (cmd == 'r') {
+            time_t now; time(&now);
+            bool synced = (unsigned long)now >= TIME_VALID_EPOCH_MIN;
+            readingStore.exportCsv(Serial, synced ? (uint32_t)now - STORE_EXPORT_WINDOW_S : 0, UINT32_MAX);
         }
     }
 
-    delay(20);
+    // Dorme só até a próxima tarefa vencer (no máximo TASK_POLL_MS)
+    if (idleMs > 0) delay(idleMs);
 }
@@ -0,0 +1,50 @@
+/**
+ * @file Arduino.h
+ * @brief Stand-in mínimo do core Arduino para os testes nativos (Print e Serial)
+ * @version 1.0.0
+ *
+ * Só o que os módulos compilados em [env:native] usam via AgriNode_Config.h.
+ */
+#ifndef AGRINODE_NATIVE_ARDUINO_H
+#define AGRINODE_NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t println(const char* s = "") { return print(s) + print("\r\n"); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buf[256];
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (n <= 0) return 0;
+        return write((const uint8_t*)buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+    }
+};
+
+// DEBUG_PRINT* vão para a saída do teste
+class HostSerial : public Print {
+public:
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+    using Print::write;
+};
+
+inline HostSerial Serial;
+
+#endif // AGRINODE_NATIVE_ARDUINO_H
@@ -0,0 +1,149 @@
+/**
+ * @file esp_partition.h
+ * @brief Emulador de flash NOR por trás da API esp_partition_* para os testes nativos
+ * @version 1.0.0
+ *
+ * Mesmas regras do chip: apagamento só por setor inteiro (bits vão a 1),
+ * programação só leva bits de 1 para 0 (a memória guarda o AND). Conta o que
+ * o firmware nunca deve fazer: programar um 0 de volta para 1 e atravessar a
+ * página de programação numa só escrita.
+ *
+ * Queda de energia: norFlashCutAfter(n) deixa passar n bytes de programação
+ * (um apagamento conta 1) e corta a escrita em andamento no meio; dali em
+ * diante nada mais chega à flash até norFlashPowerOn().
+ */
+#ifndef AGRINODE_NATIVE_ESP_PARTITION_H
+#define AGRINODE_NATIVE_ESP_PARTITION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef int esp_err_t;
+#define ESP_OK               0
+#define ESP_FAIL             -1
+#define ESP_ERR_INVALID_ARG  0x102
+#define ESP_ERR_INVALID_SIZE 0x104
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_ANY = 0xff
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+#define NOR_SECTOR_BYTES   4096
+#define NOR_PAGE_BYTES     256
+#ifndef NOR_FLASH_MAX_BYTES
+#define NOR_FLASH_MAX_BYTES (64 * NOR_SECTOR_BYTES)
+#endif
+
+struct NorFlash {
+    uint8_t data[NOR_FLASH_MAX_BYTES];
+    esp_partition_t partition;
+    bool present;
+
+    long budget;                  // bytes até a queda; < 0 = sem queda armada
+    bool powerLost;
+
+    uint32_t erases[NOR_FLASH_MAX_BYTES / NOR_SECTOR_BYTES];
+    uint32_t writes;
+    uint32_t zeroToOne;           // bits que a escrita pediu em 1 sobre um 0
+    uint32_t pageCrossings;
+};
+
+inline NorFlash norFlash;
+
+// Partição apagada de 'bytes' (múltiplo do setor) com o rótulo/subtipo dados
+inline void norFlashReset(uint32_t bytes, const char* label, uint8_t subtype) {
+    memset(&norFlash, 0, sizeof(norFlash));
+    memset(norFlash.data, 0xFF, sizeof(norFlash.data));
+    norFlash.partition.type = ESP_PARTITION_TYPE_DATA;
+    norFlash.partition.subtype = (esp_partition_subtype_t)subtype;
+    norFlash.partition.size = bytes;
+    strncpy(norFlash.partition.label, label, sizeof(norFlash.partition.label) - 1);
+    norFlash.present = true;
+    norFlash.budget = -1;
+}
+
+inline void norFlashCutAfter(long bytes) {
+    norFlash.budget = bytes;
+    norFlash.powerLost = false;
+}
+
+inline void norFlashPowerOn() {
+    norFlash.budget = -1;
+    norFlash.powerLost = false;
+}
+
+inline const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                       esp_partition_subtype_t subtype,
+                                                       const char* label) {
+    const esp_partition_t& p = norFlash.partition;
+    if (!norFlash.present || p.type != type) return nullptr;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && p.subtype != subtype) return nullptr;
+    if (label != nullptr && strcmp(label, p.label) != 0) return nullptr;
+    return &p;
+}
+
+inline esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset,
+                                    void* dst, size_t size) {
+    if (partition == nullptr || offset + size > partition->size) return ESP_ERR_INVALID_SIZE;
+    memcpy(dst, norFlash.data + offset, size);
+    return ESP_OK;
+}
+
+inline esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset,
+                                     const void* src, size_t size) {
+    if (partition == nullptr || offset + size > partition->size) return ESP_ERR_INVALID_SIZE;
+    if (size == 0) return ESP_OK;
+    if (offset / NOR_PAGE_BYTES != (offset + size - 1) / NOR_PAGE_BYTES) norFlash.pageCrossings++;
+    norFlash.writes++;
+
+    const uint8_t* in = (const uint8_t*)src;
+    for (size_t i = 0; i < size; i++) {
+        if (norFlash.powerLost) break;
+        if (norFlash.budget == 0) {
+            norFlash.powerLost = true;
+            break;
+        }
+        if (norFlash.budget > 0) norFlash.budget--;
+
+        uint8_t& cell = norFlash.data[offset + i];
+        for (uint8_t b = 0; b < 8; b++) {
+            if ((in[i] >> b & 1) && !(cell >> b & 1)) norFlash.zeroToOne++;
+        }
+        cell &= in[i];
+    }
+    return ESP_OK;
+}
+
+inline esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+    if (partition == nullptr || offset + size > partition->size) return ESP_ERR_INVALID_SIZE;
+    if (offset % NOR_SECTOR_BYTES != 0 || size % NOR_SECTOR_BYTES != 0) return ESP_ERR_INVALID_ARG;
+    if (norFlash.powerLost) return ESP_OK;
+    if (norFlash.budget == 0) {
+        norFlash.powerLost = true;
+        return ESP_OK;
+    }
+    if (norFlash.budget > 0) norFlash.budget--;
+
+    memset(norFlash.data + offset, 0xFF, size);
+    for (size_t s = offset / NOR_SECTOR_BYTES; s < (offset + size) / NOR_SECTOR_BYTES; s++) {
+        norFlash.erases[s]++;
+    }
+    return ESP_OK;
+}
+
+#endif // AGRINODE_NATIVE_ESP_PARTITION_H
@@ -0,0 +1,208 @@
+/**
+ * @file test_main.cpp
+ * @brief AgriNodeAsyncHttp contra um servidor de loopback no mesmo processo (pio test -e native)
+ *
+ * O servidor faz o papel do stand-in do Apps Script (tools/sheets_standin.py):
+ * lê o pedido inteiro e responde com o texto de cada caso.
+ */
+#include <unity.h>
+#include "AgriNode_AsyncHttp.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define MAX_POLLS  20000
+
+struct LoopbackServer {
+    int listenFd;
+    int clientFd;
+    uint16_t port;
+    char request[1024];
+    size_t requestLen;
+    bool responded;
+};
+
+static LoopbackServer server;
+static AgriNodeAsyncHttp* http;
+
+static int8_t resolveLoopback(const char* host, uint32_t& ip, void* context) {
+    ip = htonl(INADDR_LOOPBACK);
+    return 1;
+}
+
+static int8_t resolveFail(const char* host, uint32_t& ip, void* context) {
+    return -1;
+}
+
+static void serverOpen() {
+    memset(&server, 0, sizeof(server));
+    server.clientFd = -1;
+    server.listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;     // porta livre qualquer
+    bind(server.listenFd, (struct sockaddr*)&addr, sizeof(addr));
+    listen(server.listenFd, 1);
+    socklen_t len = sizeof(addr);
+    getsockname(server.listenFd, (struct sockaddr*)&addr, &len);
+    server.port = ntohs(addr.sin_port);
+    fcntl(server.listenFd, F_SETFL, fcntl(server.listenFd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static void serverClose() {
+    if (server.clientFd >= 0) close(server.clientFd);
+    if (server.listenFd >= 0) close(server.listenFd);
+    server.clientFd = server.listenFd = -1;
+}
+
+// Um passo do servidor: aceita, lê até a linha em branco e responde uma vez
+static void serverStep(const char* response, bool closeAfter) {
+    if (server.clientFd < 0) {
+        server.clientFd = accept(server.listenFd, nullptr, nullptr);
+        if (server.clientFd < 0) return;
+        fcntl(server.clientFd, F_SETFL, fcntl(server.clientFd, F_GETFL, 0) | O_NONBLOCK);
+    }
+    if (server.responded || response == nullptr) return;
+
+    ssize_t n = recv(server.clientFd, server.request + server.requestLen,
+                     sizeof(server.request) - 1 - server.requestLen, 0);
+    if (n > 0) server.requestLen += (size_t)n;
+    server.request[server.requestLen] = '\0';
+    if (strstr(server.request, "\r\n\r\n") == nullptr) return;
+
+    send(server.clientFd, response, strlen(response), 0);
+    server.responded = true;
+    if (closeAfter) {
+        close(server.clientFd);
+        server.clientFd = -1;
+    }
+}
+
+// Avança cliente e servidor com um relógio lógico de 1 ms por passada
+static void exchange(const char* path, const char* response, bool closeAfter) {
+    char url[128];
+    snprintf(url, sizeof(url), "http://script.test:%u%s", server.port, path);
+    TEST_ASSERT_TRUE(http->get(url, 0));
+
+    unsigned long now = 0;
+    for (int i = 0; i < MAX_POLLS && !http->poll(now); i++) {
+        serverStep(response, closeAfter);
+        now++;
+        usleep(50);
+    }
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_DONE, http->getState());
+}
+
+void setUp() {
+    http = new AgriNodeAsyncHttp();
+    http->setResolver(resolveLoopback, nullptr);
+    serverOpen();
+}
+
+void tearDown() {
+    delete http;
+    serverClose();
+}
+
+static void test_redirect_round_trip() {
+    exchange("/macros/s/standin/exec?node=1&soil=42.5",
+             "HTTP/1.1 302 Moved Temporarily\r\n"
+             "Location: http://127.0.0.1/macros/echo?user_content_key=abc\r\n"
+             "Content-Length: 0\r\n"
+             "\r\n", false);
+
+    TEST_ASSERT_EQUAL(302, http->getStatus());
+    TEST_ASSERT_EQUAL_STRING("http://127.0.0.1/macros/echo?user_content_key=abc", http->getLocation());
+    TEST_ASSERT_EQUAL(0, http->getContentLength());
+
+    // Pedido com caminho + query intactos e a porta fora do padrão no Host
+    char host[48];
+    snprintf(host, sizeof(host), "Host: script.test:%u\r\n", server.port);
+    TEST_ASSERT_NOT_NULL(strstr(server.request, "GET /macros/s/standin/exec?node=1&soil=42.5 HTTP/1.1\r\n"));
+    TEST_ASSERT_NOT_NULL(strstr(server.request, host));
+    TEST_ASSERT_NOT_NULL(strstr(server.request, "Connection: close\r\n"));
+}
+
+static void test_body_by_content_length() {
+    // Servidor mantém a conexão: o fim vem do Content-Length
+    exchange("/exec", "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nOK", false);
+    TEST_ASSERT_EQUAL(200, http->getStatus());
+    TEST_ASSERT_EQUAL_STRING("OK", http->getBody());
+}
+
+static void test_body_until_close() {
+    exchange("/exec", "HTTP/1.0 200 OK\r\n\r\nlinha 1\nlinha 2", true);
+    TEST_ASSERT_EQUAL(200, http->getStatus());
+    TEST_ASSERT_EQUAL_STRING("linha 1 linha 2", http->getBody());   // log em uma linha
+}
+
+static void test_truncated_status_line() {
+    exchange("/exec", "HTTP/1.\r\n\r\n", true);
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_ERR_PROTOCOL, http->getStatus());
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_RECEIVING, http->getFailedState());
+}
+
+static void test_not_http() {
+    exchange("/exec", "SSH-2.0-OpenSSH\r\n\r\n", true);
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_ERR_PROTOCOL, http->getStatus());
+}
+
+static void test_phase_timeout() {
+    char url[64];
+    snprintf(url, sizeof(url), "http://script.test:%u/exec", server.port);
+    TEST_ASSERT_TRUE(http->get(url, 0));
+
+    // Servidor aceita e nunca responde
+    unsigned long now = 0;
+    for (int i = 0; i < MAX_POLLS && http->getState() != ASYNC_HTTP_RECEIVING; i++) {
+        http->poll(now);
+        serverStep(nullptr, false);
+        usleep(50);
+    }
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_RECEIVING, http->getState());
+
+    TEST_ASSERT_FALSE(http->poll(now + ASYNC_HTTP_PHASE_TIMEOUT_MS - 1));
+    TEST_ASSERT_TRUE(http->poll(now + ASYNC_HTTP_PHASE_TIMEOUT_MS));
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_ERR_TIMEOUT, http->getStatus());
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_RECEIVING, http->getFailedState());
+}
+
+static void test_dns_failure() {
+    http->setResolver(resolveFail, nullptr);
+    TEST_ASSERT_TRUE(http->get("http://script.test/exec", 0));
+    TEST_ASSERT_TRUE(http->poll(1));
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_ERR_DNS, http->getStatus());
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_RESOLVING, http->getFailedState());
+}
+
+static void test_bad_urls() {
+    TEST_ASSERT_FALSE(http->get("ftp://script.test/", 0));
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_ERR_URL, http->getStatus());
+    TEST_ASSERT_FALSE(http->get("http://script.test:99999/", 0));
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_ERR_URL, http->getStatus());
+#if !ASYNC_HTTP_TLS
+    TEST_ASSERT_FALSE(http->get("https://script.test/", 0));
+    TEST_ASSERT_EQUAL(ASYNC_HTTP_ERR_TLS, http->getStatus());
+#endif
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_redirect_round_trip);
+    RUN_TEST(test_body_by_content_length);
+    RUN_TEST(test_body_until_close);
+    RUN_TEST(test_truncated_status_line);
+    RUN_TEST(test_not_http);
+    RUN_TEST(test_phase_timeout);
+    RUN_TEST(test_dns_failure);
+    RUN_TEST(test_bad_urls);
+    return UNITY_END();
+}
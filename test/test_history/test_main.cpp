@@ -0,0 +1,152 @@
+/**
+ * @file test_main.cpp
+ * @brief Ida e volta exata do codificador de AgriNodeHistory (pio test -e native)
+ */
+#include <unity.h>
+#include "AgriNode_History.h"
+#include "AgriNode_Noise.h"
+#include <math.h>
+
+#define MAX_READINGS  4096
+
+static HistoryReading written[MAX_READINGS];
+static uint16_t writtenCount;
+static HistoryReading decoded[MAX_READINGS];
+static uint16_t decodedCount;
+
+static void collect(const HistoryReading& r, void* context) {
+    if (decodedCount < MAX_READINGS) decoded[decodedCount] = r;
+    decodedCount++;
+}
+
+static float quantized(float v) {
+    float q = floorf(v * HISTORY_SCALE + 0.5f);
+    if (q > 32767.0f) q = 32767.0f;
+    if (q < -32768.0f) q = -32768.0f;
+    return q / HISTORY_SCALE;
+}
+
+static void add(AgriNodeHistory& h, uint32_t time, float soil, float temp, float hum, int8_t status) {
+    HistoryReading r;
+    r.time = time;
+    r.soilMoisture = soil;
+    r.ambientTemp = temp;
+    r.humidity = hum;
+    r.irrigationStatus = status;
+    h.append(r);
+    written[writtenCount++ % MAX_READINGS] = r;
+}
+
+// Os últimos h.size() gravados voltam iguais (valores na resolução guardada)
+static void assertRoundTrip(const AgriNodeHistory& h) {
+    decodedCount = 0;
+    TEST_ASSERT_EQUAL(h.size(), h.forEach(collect, nullptr));
+    TEST_ASSERT_EQUAL(h.size(), decodedCount);
+
+    uint16_t first = writtenCount - decodedCount;
+    for (uint16_t i = 0; i < decodedCount; i++) {
+        const HistoryReading& w = written[(first + i) % MAX_READINGS];
+        const HistoryReading& d = decoded[i];
+        TEST_ASSERT_EQUAL_UINT32(w.time, d.time);
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, quantized(w.soilMoisture), d.soilMoisture);
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, quantized(w.ambientTemp), d.ambientTemp);
+        TEST_ASSERT_FLOAT_WITHIN(1e-4f, quantized(w.humidity), d.humidity);
+        TEST_ASSERT_EQUAL_INT8(w.irrigationStatus, d.irrigationStatus);
+    }
+}
+
+void setUp() {
+    writtenCount = 0;
+    decodedCount = 0;
+}
+
+void tearDown() {}
+
+static void test_periodic_noisy_round_trip() {
+    static AgriNodeHistory h;
+    h.clear();
+    AgriNodeNoise noise(2024);
+    uint32_t t = 1700000000UL;
+    float soil = 55.0f;
+    for (uint16_t i = 0; i < 200; i++) {
+        t += 30 + ((i % 17 == 0) ? 1 : 0);      // período fixo com jitter ocasional
+        soil -= 0.05f;
+        add(h, t, soil + 0.3f * noise.gaussian(), 25.0f + 0.2f * noise.gaussian(),
+            60.0f + 0.5f * noise.gaussian(), 0);
+    }
+    TEST_ASSERT_EQUAL(0, h.getDropped());
+    assertRoundTrip(h);
+
+    // Com o ruído do simulador: bem abaixo dos 17 bytes crus por leitura
+    float bytesPerReading = (float)h.bytesUsed() / h.size();
+    TEST_ASSERT_LESS_THAN(4.0f, bytesPerReading);
+}
+
+static void test_time_buckets() {
+    static AgriNodeHistory h;
+    h.clear();
+    // dod 0, pequeno, médio, grande, negativo e um salto de 32 bits
+    static const uint32_t steps[] = {30, 30, 31, 60, 30, 300, 1500, 30, 5, 100000, 30, 30};
+    uint32_t t = 1000;
+    add(h, t, 50.0f, 25.0f, 60.0f, 0);
+    for (uint8_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        t += steps[i];
+        add(h, t, 50.0f, 25.0f, 60.0f, 0);
+    }
+    assertRoundTrip(h);
+}
+
+static void test_absolute_values() {
+    static AgriNodeHistory h;
+    h.clear();
+    // Saltos além de 9 bits (±25.6) usam o valor absoluto de 16 bits
+    add(h, 0, 0.0f, -40.0f, 0.0f, 0);
+    add(h, 30, 100.0f, 85.0f, 100.0f, 0);
+    add(h, 60, 0.1f, -40.0f, 99.9f, 0);
+    add(h, 90, 25.5f, -14.4f, 74.3f, 0);        // no limite do bucket de 9 bits
+    add(h, 120, 5000.0f, -5000.0f, -0.04f, 0);  // saturado em ±3276.x
+    add(h, 150, 0.0f, 0.0f, 0.0f, 0);
+    assertRoundTrip(h);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 3276.7f, decoded[4].soilMoisture);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -3276.8f, decoded[4].ambientTemp);
+}
+
+static void test_status_changes() {
+    static AgriNodeHistory h;
+    h.clear();
+    static const int8_t status[] = {0, 1, 1, 2, 0, 0, 2, 1, 0};
+    for (uint8_t i = 0; i < sizeof(status); i++) add(h, 30 * i, 40.0f, 25.0f, 60.0f, status[i]);
+    assertRoundTrip(h);
+}
+
+static void test_block_rollover_drops_oldest() {
+    static AgriNodeHistory h;
+    h.clear();
+    AgriNodeNoise noise(7);
+    uint32_t t = 0;
+    for (uint16_t i = 0; i < 3000; i++) {
+        t += 30;
+        add(h, t, 50.0f + noise.gaussian(), 25.0f + noise.gaussian(), 60.0f + noise.gaussian(), (i / 500) % 3);
+    }
+
+    // Anel deu várias voltas: nada perdido além de blocos inteiros
+    TEST_ASSERT_GREATER_THAN(0, h.getDropped());
+    TEST_ASSERT_EQUAL(3000, h.size() + h.getDropped());
+    TEST_ASSERT_LESS_OR_EQUAL(HISTORY_BLOCKS * HISTORY_BLOCK_BYTES, h.bytesUsed());
+    assertRoundTrip(h);
+
+    h.clear();
+    TEST_ASSERT_EQUAL(0, h.size());
+    TEST_ASSERT_EQUAL(0, h.getDropped());
+    TEST_ASSERT_EQUAL(0, h.forEach(collect, nullptr));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_periodic_noisy_round_trip);
+    RUN_TEST(test_time_buckets);
+    RUN_TEST(test_absolute_values);
+    RUN_TEST(test_status_changes);
+    RUN_TEST(test_block_rollover_drops_oldest);
+    return UNITY_END();
+}
@@ -0,0 +1,126 @@
+/**
+ * @file test_main.cpp
+ * @brief Momentos, caudas e reprodutibilidade do Ziggurat de AgriNodeNoise (pio test -e native)
+ */
+#include <unity.h>
+#include "AgriNode_Noise.h"
+#include <math.h>
+
+#define SAMPLES  10000000UL
+#define BATCH    1024
+
+// Limites com ~6 desvios-padrão de folga para SAMPLES amostras
+struct Moments {
+    double mean;
+    double variance;
+    double skewness;
+    double kurtosis;
+    double tail[5];          // P(|x| > 1, 2, 3, 3.5, 4)
+};
+
+static const double tailAt[5]    = {1.0, 2.0, 3.0, 3.5, 4.0};
+static const double tailExact[5] = {0.31731051, 0.04550026, 0.00269980, 0.00046525, 0.00006334};
+static const double tailTol[5]   = {1e-3, 4e-4, 1e-4, 4e-5, 2e-5};
+
+static Moments moments;
+
+void setUp() {}
+void tearDown() {}
+
+static void measure() {
+    AgriNodeNoise noise(12345);
+    static float batch[BATCH];
+    double s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+    unsigned long beyond[5] = {0, 0, 0, 0, 0};
+
+    for (unsigned long done = 0; done < SAMPLES; done += BATCH) {
+        noise.fill(batch, BATCH);
+        for (size_t i = 0; i < BATCH; i++) {
+            double x = batch[i];
+            double x2 = x * x;
+            s1 += x;
+            s2 += x2;
+            s3 += x2 * x;
+            s4 += x2 * x2;
+            double a = fabs(x);
+            for (uint8_t t = 0; t < 5; t++) {
+                if (a > tailAt[t]) beyond[t]++;
+            }
+        }
+    }
+
+    double n = (double)((SAMPLES + BATCH - 1) / BATCH * BATCH);
+    moments.mean = s1 / n;
+    moments.variance = s2 / n - moments.mean * moments.mean;
+    moments.skewness = s3 / n;
+    moments.kurtosis = s4 / n;
+    for (uint8_t t = 0; t < 5; t++) moments.tail[t] = beyond[t] / n;
+}
+
+static void test_mean_and_variance() {
+    TEST_ASSERT_DOUBLE_WITHIN(0.002, 0.0, moments.mean);
+    TEST_ASSERT_DOUBLE_WITHIN(0.003, 1.0, moments.variance);
+}
+
+static void test_higher_moments() {
+    TEST_ASSERT_DOUBLE_WITHIN(0.01, 0.0, moments.skewness);
+    TEST_ASSERT_DOUBLE_WITHIN(0.02, 3.0, moments.kurtosis);
+}
+
+static void test_tail_probabilities() {
+    // 3.5 e 4 caem além de ZIG_R: exercitam a amostragem da cauda da camada 0
+    for (uint8_t t = 0; t < 5; t++) {
+        TEST_ASSERT_DOUBLE_WITHIN(tailTol[t], tailExact[t], moments.tail[t]);
+    }
+}
+
+static void test_same_seed_same_sequence() {
+    AgriNodeNoise a(42), b(42), c(43);
+    bool differs = false;
+    for (int i = 0; i < 100000; i++) {
+        float x = a.gaussian();
+        TEST_ASSERT_EQUAL_FLOAT(x, b.gaussian());
+        if (x != c.gaussian()) differs = true;
+    }
+    TEST_ASSERT_TRUE(differs);
+
+    // seed() reinicia a sequência
+    float first[16];
+    a.seed(7);
+    for (int i = 0; i < 16; i++) first[i] = a.gaussian();
+    a.seed(7);
+    for (int i = 0; i < 16; i++) TEST_ASSERT_EQUAL_FLOAT(first[i], a.gaussian());
+}
+
+static void test_fill_matches_gaussian() {
+    AgriNodeNoise a(99), b(99);
+    float batch[BATCH];
+    a.fill(batch, BATCH);
+    for (size_t i = 0; i < BATCH; i++) TEST_ASSERT_EQUAL_FLOAT(batch[i], b.gaussian());
+}
+
+static void test_zero_seed_and_uniform_range() {
+    AgriNodeNoise noise(0);      // xorshift preso no zero seria sempre 0
+    bool nonZero = false;
+    for (int i = 0; i < 1000; i++) {
+        if (noise.gaussian() != 0.0f) nonZero = true;
+    }
+    TEST_ASSERT_TRUE(nonZero);
+
+    for (int i = 0; i < 1000000; i++) {
+        float u = noise.uniform();
+        TEST_ASSERT_TRUE(u > 0.0f && u < 1.0f);
+    }
+}
+
+int main(int argc, char** argv) {
+    measure();
+    UNITY_BEGIN();
+    RUN_TEST(test_mean_and_variance);
+    RUN_TEST(test_higher_moments);
+    RUN_TEST(test_tail_probabilities);
+    RUN_TEST(test_same_seed_same_sequence);
+    RUN_TEST(test_fill_matches_gaussian);
+    RUN_TEST(test_zero_seed_and_uniform_range);
+    return UNITY_END();
+}
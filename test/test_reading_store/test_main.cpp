@@ -0,0 +1,272 @@
+/**
+ * @file test_main.cpp
+ * @brief AgriNodeReadingStore sobre flash NOR emulada: anexação, selagem, rodízio, queda de energia
+ *        e consultas (pio test -e native)
+ */
+#include <unity.h>
+#include "AgriNode_ReadingStore.h"
+
+#define SEGMENTS        6
+#define RECORDS_PER_SEG (STORE_SEGMENT_BYTES / sizeof(StoredReading) - 1)   // slot 0 = cabeçalho
+#define EPOCH_BASE      1700000000UL
+#define MAX_SEEN        (SEGMENTS * RECORDS_PER_SEG + 64)
+
+static uint32_t seen[MAX_SEEN];
+static uint32_t seenCount;
+
+static void collect(const StoredReading& r, void* context) {
+    if (seenCount < MAX_SEEN) seen[seenCount] = r.epoch;
+    seenCount++;
+}
+
+static uint32_t queryAll(AgriNodeReadingStore& store, uint32_t from = 0, uint32_t to = UINT32_MAX,
+                         uint16_t sourceId = 0) {
+    seenCount = 0;
+    return store.query(from, to, sourceId, collect, nullptr);
+}
+
+// Leitura de nó cujo epoch identifica a ordem de anexação
+static bool appendReading(AgriNodeReadingStore& store, uint32_t epoch, uint16_t nodeId = 1) {
+    AgriculturalNode node;
+    memset(&node, 0, sizeof(node));
+    node.nodeId = nodeId;
+    node.dataTimestamp = epoch;
+    node.soilMoisture = 42.5f;
+    node.ambientTemp = -3.25f;
+    node.humidity = 61.0f;
+    node.irrigationStatus = IRRIGATION_ON;
+    return store.appendNode(node);
+}
+
+// Epochs entregues formam uma sequência contígua (sem duplicata nem buraco)
+static bool consecutive() {
+    for (uint32_t i = 1; i < seenCount && i < MAX_SEEN; i++) {
+        if (seen[i] != seen[i - 1] + 1) return false;
+    }
+    return true;
+}
+
+static void assertFlashRules() {
+    TEST_ASSERT_EQUAL(0, norFlash.zeroToOne);
+    TEST_ASSERT_EQUAL(0, norFlash.pageCrossings);
+}
+
+void setUp() {
+    norFlashReset(SEGMENTS * STORE_SEGMENT_BYTES, STORE_PARTITION_LABEL, STORE_PARTITION_SUBTYPE);
+    seenCount = 0;
+}
+
+void tearDown() {}
+
+static void test_missing_partition() {
+    norFlash.present = false;
+    AgriNodeReadingStore store;
+    TEST_ASSERT_FALSE(store.begin());
+    TEST_ASSERT_FALSE(appendReading(store, EPOCH_BASE));
+    TEST_ASSERT_EQUAL(0, queryAll(store));
+}
+
+static void test_append_and_query() {
+    AgriNodeReadingStore store;
+    TEST_ASSERT_TRUE(store.begin());
+    TEST_ASSERT_EQUAL(SEGMENTS, store.getSegmentCount());
+
+    for (uint32_t i = 0; i < 600; i++) appendReading(store, EPOCH_BASE + i, 1 + i % 3);
+
+    // Inclui a página ainda em RAM, em ordem de anexação
+    TEST_ASSERT_EQUAL(600, queryAll(store));
+    TEST_ASSERT_EQUAL(EPOCH_BASE, seen[0]);
+    TEST_ASSERT_TRUE(consecutive());
+
+    TEST_ASSERT_EQUAL(100, queryAll(store, EPOCH_BASE + 250, EPOCH_BASE + 349));
+    TEST_ASSERT_EQUAL(EPOCH_BASE + 250, seen[0]);
+    TEST_ASSERT_EQUAL(200, queryAll(store, 0, UINT32_MAX, 2));
+
+    // Registro volta com os valores em x100
+    struct Check {
+        static void one(const StoredReading& r, void* context) { *(StoredReading*)context = r; }
+    };
+    StoredReading r;
+    store.query(EPOCH_BASE + 7, EPOCH_BASE + 7, 0, Check::one, &r);
+    TEST_ASSERT_EQUAL(READING_NODE, r.kind);
+    TEST_ASSERT_EQUAL(2, r.sourceId);
+    TEST_ASSERT_EQUAL(IRRIGATION_ON, r.status);
+    TEST_ASSERT_EQUAL(4250, r.value[0]);
+    TEST_ASSERT_EQUAL(-325, r.value[1]);
+    TEST_ASSERT_EQUAL(6100, r.value[2]);
+    assertFlashRules();
+}
+
+static void test_flush_timer_persists_partial_page() {
+    AgriNodeReadingStore store;
+    store.begin();
+    for (uint32_t i = 0; i < 5; i++) appendReading(store, EPOCH_BASE + i);
+    uint32_t writes = norFlash.writes;
+
+    store.step(0);                          // agenda o próximo flush
+    TEST_ASSERT_EQUAL(writes, norFlash.writes);
+    store.step(STORE_FLUSH_INTERVAL_MS);
+    TEST_ASSERT_EQUAL(writes + 1, norFlash.writes);
+
+    AgriNodeReadingStore rebooted;
+    rebooted.begin();
+    TEST_ASSERT_EQUAL(5, queryAll(rebooted));
+}
+
+static void test_ring_rotation_and_wear() {
+    AgriNodeReadingStore store;
+    store.begin();
+    const uint32_t total = (uint32_t)(SEGMENTS * RECORDS_PER_SEG * 3 + 100);
+    for (uint32_t i = 0; i < total; i++) appendReading(store, EPOCH_BASE + i);
+    store.flush();
+
+    uint32_t stored, dropped, crcErrors;
+    uint16_t segments;
+    store.getStatistics(stored, segments, dropped, crcErrors);
+    TEST_ASSERT_EQUAL(SEGMENTS, segments);
+    TEST_ASSERT_EQUAL(total, stored + dropped);
+    TEST_ASSERT_EQUAL(0, dropped % RECORDS_PER_SEG);   // sai sempre um segmento inteiro
+
+    // Sobrevive o final contíguo do que foi anexado
+    TEST_ASSERT_EQUAL(stored, queryAll(store));
+    TEST_ASSERT_TRUE(consecutive());
+    TEST_ASSERT_EQUAL(EPOCH_BASE + total - 1, seen[seenCount - 1]);
+
+    // Índice de epochs descarta segmentos fora do intervalo sem perder nada
+    uint32_t oldest = seen[0];
+    TEST_ASSERT_EQUAL(10, queryAll(store, oldest + 300, oldest + 309));
+    TEST_ASSERT_EQUAL(0, queryAll(store, EPOCH_BASE, oldest - 1));
+
+    // Nivelamento: cada setor apagado o mesmo número de vezes (±1)
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (uint8_t s = 0; s < SEGMENTS; s++) {
+        if (norFlash.erases[s] < lo) lo = norFlash.erases[s];
+        if (norFlash.erases[s] > hi) hi = norFlash.erases[s];
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(1, hi - lo);
+    assertFlashRules();
+}
+
+static void test_reboot_continues_log() {
+    {
+        AgriNodeReadingStore store;
+        store.begin();
+        for (uint32_t i = 0; i < 700; i++) appendReading(store, EPOCH_BASE + i);
+        store.flush();
+    }
+
+    AgriNodeReadingStore store;
+    TEST_ASSERT_TRUE(store.begin());
+    TEST_ASSERT_EQUAL(700, queryAll(store));
+    for (uint32_t i = 700; i < 800; i++) appendReading(store, EPOCH_BASE + i);
+    store.flush();
+
+    AgriNodeReadingStore again;
+    again.begin();
+    TEST_ASSERT_EQUAL(800, queryAll(again));
+    TEST_ASSERT_TRUE(consecutive());
+
+    uint32_t stored, dropped, crcErrors;
+    uint16_t segments;
+    again.getStatistics(stored, segments, dropped, crcErrors);
+    TEST_ASSERT_EQUAL(0, crcErrors);
+    assertFlashRules();
+}
+
+// Corta a energia em cada ponto de uma janela que atravessa selagem,
+// apagamento e cabeçalho do próximo segmento com o anel já cheio
+static void test_power_cut_sweep() {
+    const uint32_t prefill = (uint32_t)(SEGMENTS * RECORDS_PER_SEG + 200);
+    {
+        AgriNodeReadingStore store;
+        store.begin();
+        for (uint32_t i = 0; i < prefill; i++) appendReading(store, EPOCH_BASE + i);
+        store.flush();
+    }
+    static NorFlash before;
+    before = norFlash;
+
+    const uint32_t burst = 120;              // atravessa o fim do segmento atual
+    uint32_t tornDetected = 0;
+    for (long cut = 0; cut < (long)(burst * sizeof(StoredReading) + 64); cut += 3) {
+        norFlash = before;
+
+        uint32_t epoch = EPOCH_BASE + prefill;
+        uint32_t durable = epoch - 1;        // último epoch com flush() concluído antes da queda
+        {
+            AgriNodeReadingStore store;
+            store.begin();
+            norFlashCutAfter(cut);
+            for (uint32_t i = 0; i < burst; i++) {
+                appendReading(store, epoch++);
+                if (i % 10 == 9) {
+                    store.flush();
+                    if (!norFlash.powerLost) durable = epoch - 1;
+                }
+            }
+        }
+        norFlashPowerOn();
+
+        AgriNodeReadingStore rebooted;
+        TEST_ASSERT_TRUE(rebooted.begin());
+        uint32_t stored, dropped, crcErrors;
+        uint16_t segments;
+        rebooted.getStatistics(stored, segments, dropped, crcErrors);
+        tornDetected += crcErrors;
+
+        // Nada do que foi confirmado se perde; nada inventado; ordem intacta
+        queryAll(rebooted);
+        TEST_ASSERT_TRUE(consecutive());
+        TEST_ASSERT_GREATER_OR_EQUAL(durable, seen[seenCount - 1]);
+        TEST_ASSERT_LESS_THAN(epoch, seen[seenCount - 1]);
+        uint32_t last = seen[seenCount - 1];
+        TEST_ASSERT_EQUAL(seenCount, queryAll(rebooted, seen[0], last));
+
+        // Depois do boot o log continua atrás do que sobrou
+        for (uint32_t i = 0; i < 300; i++) appendReading(rebooted, epoch + i);
+        rebooted.flush();
+        AgriNodeReadingStore again;
+        again.begin();
+        queryAll(again);
+        TEST_ASSERT_EQUAL(epoch + 299, seen[seenCount - 1]);
+        TEST_ASSERT_EQUAL(300, queryAll(again, epoch, epoch + 299));
+        assertFlashRules();
+    }
+    // Pelo menos um corte caiu no meio de um registro e foi rejeitado pelo CRC
+    TEST_ASSERT_GREATER_THAN(0, tornDetected);
+}
+
+static void test_export_csv() {
+    struct Capture : public Print {
+        char text[4096];
+        size_t len = 0;
+        size_t write(uint8_t c) override {
+            if (len < sizeof(text) - 1) text[len++] = (char)c;
+            text[len] = '\0';
+            return 1;
+        }
+        using Print::write;
+    } out;
+
+    AgriNodeReadingStore store;
+    store.begin();
+    for (uint32_t i = 0; i < 3; i++) appendReading(store, EPOCH_BASE + i);
+    store.exportCsv(out, EPOCH_BASE + 1, EPOCH_BASE + 2);
+
+    TEST_ASSERT_EQUAL(0, strncmp(out.text, "kind,sourceId,epoch,v0,v1,v2,status", 35));
+    TEST_ASSERT_NOT_NULL(strstr(out.text, "1,1,1700000001,42.50,-3.25,61.00,1\n"));
+    TEST_ASSERT_NULL(strstr(out.text, "1700000000"));
+    TEST_ASSERT_NOT_NULL(strstr(out.text, "# 2 registros"));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_missing_partition);
+    RUN_TEST(test_append_and_query);
+    RUN_TEST(test_flush_timer_persists_partial_page);
+    RUN_TEST(test_ring_rotation_and_wear);
+    RUN_TEST(test_reboot_continues_log);
+    RUN_TEST(test_power_cut_sweep);
+    RUN_TEST(test_export_csv);
+    return UNITY_END();
+}
@@ -0,0 +1,202 @@
+/**
+ * @file test_main.cpp
+ * @brief AgriNodeSensorScheduler com drivers AgriNodeFakeSensor (pio test -e native)
+ */
+#include <unity.h>
+#include "AgriNode_SensorScheduler.h"
+#include "AgriNode_FakeSensor.h"
+
+#define NO_RADIO  1000000UL   // folga do LoRa maior que qualquer conversão
+
+static SensorReading received[32];
+static uint8_t receivedCount;
+
+static void collect(const SensorReading& r, void* context) {
+    if (receivedCount < sizeof(received) / sizeof(received[0])) received[receivedCount] = r;
+    receivedCount++;
+}
+
+// Driver que falha no begin() ou no start(), para os caminhos de erro
+class BrokenSensor : public AgriNodeFakeSensor {
+public:
+    BrokenSensor(bool failBegin, bool failStart) :
+        AgriNodeFakeSensor(9, SENSOR_TEMPERATURE, 10, 0.0f, 0.0f),
+        _failBegin(failBegin), _failStart(failStart), _starts(0) {}
+
+    bool begin() override { return !_failBegin; }
+    bool start(unsigned long now) override {
+        _starts++;
+        return _failStart ? false : AgriNodeFakeSensor::start(now);
+    }
+    uint32_t starts() const { return _starts; }
+
+private:
+    bool _failBegin;
+    bool _failStart;
+    uint32_t _starts;
+};
+
+void setUp() {
+    receivedCount = 0;
+}
+
+void tearDown() {}
+
+static void test_conversions_interleave() {
+    AgriNodeSensorScheduler s;
+    AgriNodeFakeSensor a(1, SENSOR_TEMPERATURE, 750, 25.0f, 1.0f);
+    AgriNodeFakeSensor b(2, SENSOR_HUMIDITY, 750, 60.0f, 5.0f);
+    s.add(&a, 1000);
+    s.add(&b, 1000);
+    s.onReading(collect, nullptr);
+    TEST_ASSERT_EQUAL(2, s.begin(0));
+
+    s.update(0, NO_RADIO);        // a vence em 0
+    s.update(500, NO_RADIO);      // b vence em 500, com a ainda convertendo
+    TEST_ASSERT_EQUAL(1, a.getCycles());
+    TEST_ASSERT_EQUAL(1, b.getCycles());
+    TEST_ASSERT_EQUAL(0, receivedCount);
+
+    s.update(750, NO_RADIO);
+    TEST_ASSERT_EQUAL(1, receivedCount);
+    TEST_ASSERT_EQUAL(1, received[0].sensorId);
+    TEST_ASSERT_EQUAL(750, received[0].takenAt);
+
+    // Ambas em 1250 ms, não 1500 (750 + 750 em série)
+    s.update(1250, NO_RADIO);
+    TEST_ASSERT_EQUAL(2, receivedCount);
+    TEST_ASSERT_EQUAL(2, received[1].sensorId);
+    TEST_ASSERT_EQUAL(SENSOR_HUMIDITY, received[1].kind);
+}
+
+static void test_held_bus_serializes() {
+    AgriNodeSensorScheduler s;
+    AgriNodeFakeSensor a(1, SENSOR_TEMPERATURE, 750, 25.0f, 0.0f, SENSOR_BUS_ONEWIRE, true);
+    AgriNodeFakeSensor b(2, SENSOR_TEMPERATURE, 750, 25.0f, 0.0f, SENSOR_BUS_ONEWIRE, true);
+    s.add(&a, 100);
+    s.add(&b, 100);
+    s.begin(0);
+
+    s.update(100, NO_RADIO);
+    TEST_ASSERT_EQUAL(1, a.getCycles());
+    TEST_ASSERT_EQUAL(0, b.getCycles());   // barramento preso pela conversão de a
+
+    s.update(850, NO_RADIO);               // a termina e libera o barramento
+    TEST_ASSERT_EQUAL(1, b.getCycles());
+}
+
+static void test_per_tick_budget() {
+    AgriNodeSensorScheduler s;
+    AgriNodeFakeSensor* f[6];
+    for (uint8_t i = 0; i < 6; i++) {
+        f[i] = new AgriNodeFakeSensor(i + 1, SENSOR_TEMPERATURE, 0, 20.0f, 0.0f);
+        s.add(f[i], 60);
+    }
+    s.onReading(collect, nullptr);
+    s.begin(0);                            // vencimentos 0, 10, ..., 50
+
+    s.update(100, NO_RADIO);
+    for (uint8_t i = 0; i < 6; i++) {
+        TEST_ASSERT_EQUAL(i < SENSOR_MAX_TRANSACTIONS_PER_TICK ? 1 : 0, f[i]->getCycles());
+    }
+
+    // Leituras gastam o orçamento do tick inteiro
+    s.update(101, NO_RADIO);
+    TEST_ASSERT_EQUAL(SENSOR_MAX_TRANSACTIONS_PER_TICK, receivedCount);
+    TEST_ASSERT_EQUAL(0, f[4]->getCycles());
+
+    // Round-robin: quem ficou de fora começa primeiro
+    s.update(102, NO_RADIO);
+    TEST_ASSERT_EQUAL(1, f[4]->getCycles());
+    TEST_ASSERT_EQUAL(1, f[5]->getCycles());
+
+    for (uint8_t i = 0; i < 6; i++) delete f[i];
+}
+
+static void test_quiet_window_defers() {
+    AgriNodeSensorScheduler s;
+    AgriNodeFakeSensor a(1, SENSOR_TEMPERATURE, 750, 25.0f, 0.0f);
+    s.add(&a, 10000);
+    s.begin(0);
+
+    uint32_t readings, errors, deferred;
+    s.update(0, 100);              // conversão não cabe antes do próximo TX
+    s.update(50, 100);
+    TEST_ASSERT_EQUAL(0, a.getCycles());
+    s.getStatistics(readings, errors, deferred);
+    TEST_ASSERT_EQUAL(1, deferred);  // um adiamento por ciclo, não por tick
+
+    s.update(60, 750);             // folga suficiente
+    TEST_ASSERT_EQUAL(1, a.getCycles());
+}
+
+static void test_deferral_capped() {
+    AgriNodeSensorScheduler s;
+    AgriNodeFakeSensor a(1, SENSOR_TEMPERATURE, 750, 25.0f, 0.0f);
+    s.add(&a, 10000);
+    s.begin(0);
+
+    s.update(SENSOR_MAX_DEFER_MS - 1, 0);
+    TEST_ASSERT_EQUAL(0, a.getCycles());
+    // Rádio nunca folga: depois de SENSOR_MAX_DEFER_MS converte mesmo assim
+    s.update(SENSOR_MAX_DEFER_MS, 0);
+    TEST_ASSERT_EQUAL(1, a.getCycles());
+}
+
+static void test_poll_error_reschedules() {
+    AgriNodeSensorScheduler s;
+    AgriNodeFakeSensor a(1, SENSOR_TEMPERATURE, 100, 25.0f, 0.0f);
+    a.setFailEvery(2);
+    s.add(&a, 1000);
+    s.onReading(collect, nullptr);
+    s.begin(0);
+
+    s.update(0, NO_RADIO);
+    s.update(100, NO_RADIO);       // ciclo 1: ok
+    s.update(1000, NO_RADIO);
+    s.update(1100, NO_RADIO);      // ciclo 2: erro, sem leitura
+
+    uint32_t readings, errors, deferred;
+    s.getStatistics(readings, errors, deferred);
+    TEST_ASSERT_EQUAL(1, readings);
+    TEST_ASSERT_EQUAL(1, errors);
+    TEST_ASSERT_EQUAL(1, receivedCount);
+
+    // Volta ao agendamento normal
+    s.update(2000, NO_RADIO);
+    TEST_ASSERT_EQUAL(3, a.getCycles());
+}
+
+static void test_begin_and_start_failures() {
+    AgriNodeSensorScheduler s;
+    BrokenSensor dead(true, false);
+    BrokenSensor stuck(false, true);
+    s.add(&dead, 1000);
+    s.add(&stuck, 1000);
+    TEST_ASSERT_EQUAL(1, s.begin(0));   // dead fica desativado
+
+    s.update(500, NO_RADIO);
+    s.update(600, NO_RADIO);            // stuck reagendado para 1500, não a cada tick
+    TEST_ASSERT_EQUAL(0, dead.starts());
+    TEST_ASSERT_EQUAL(1, stuck.starts());
+
+    s.update(1500, NO_RADIO);
+    TEST_ASSERT_EQUAL(2, stuck.starts());
+
+    uint32_t readings, errors, deferred;
+    s.getStatistics(readings, errors, deferred);
+    TEST_ASSERT_EQUAL(0, readings);
+    TEST_ASSERT_EQUAL(2, errors);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_conversions_interleave);
+    RUN_TEST(test_held_bus_serializes);
+    RUN_TEST(test_per_tick_budget);
+    RUN_TEST(test_quiet_window_defers);
+    RUN_TEST(test_deferral_capped);
+    RUN_TEST(test_poll_error_reschedules);
+    RUN_TEST(test_begin_and_start_failures);
+    return UNITY_END();
+}
@@ -0,0 +1,146 @@
+/**
+ * @file test_main.cpp
+ * @brief Coalescência, prioridade de alarmes e descarte da AgriNodeTxQueue (pio test -e native)
+ */
+#include <unity.h>
+#include "AgriNode_TxQueue.h"
+
+static TxFrame frame(uint16_t nodeId, unsigned long capturedAt, float soil, bool alarm = false) {
+    TxFrame f;
+    f.nodeId = nodeId;
+    f.soilMoisture = soil;
+    f.ambientTemp = 25.0f;
+    f.humidity = 60.0f;
+    f.irrigationStatus = 0;
+    f.dataTimestamp = 0;
+    f.capturedAt = capturedAt;
+    f.alarm = alarm;
+    return f;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_coalesce_in_place() {
+    AgriNodeTxQueue q;
+    q.push(frame(1, 100, 40.0f));
+    q.push(frame(2, 110, 50.0f));
+    TEST_ASSERT_TRUE(q.push(frame(1, 200, 41.0f)));   // substitui, não cresce
+    TEST_ASSERT_EQUAL(2, q.size());
+
+    // Nó 1 mantém a posição (antes do 2), com o dado mais novo
+    TxFrame out;
+    TEST_ASSERT_TRUE(q.pop(out));
+    TEST_ASSERT_EQUAL(1, out.nodeId);
+    TEST_ASSERT_EQUAL(200, out.capturedAt);
+    TEST_ASSERT_EQUAL_FLOAT(41.0f, out.soilMoisture);
+    TEST_ASSERT_TRUE(q.pop(out));
+    TEST_ASSERT_EQUAL(2, out.nodeId);
+    TEST_ASSERT_FALSE(q.pop(out));
+
+    uint32_t coalesced, dropped, alarms;
+    q.getStatistics(coalesced, dropped, alarms);
+    TEST_ASSERT_EQUAL(1, coalesced);
+    TEST_ASSERT_EQUAL(0, dropped);
+}
+
+static void test_stale_repush_rejected() {
+    AgriNodeTxQueue q;
+    TxFrame sent = frame(3, 100, 30.0f);
+    q.push(sent);
+    TxFrame out;
+    q.pop(out);                                 // em transmissão
+    q.push(frame(3, 150, 35.0f));               // leitura nova chega durante o TX
+
+    // TX falhou: o frame antigo volta, mas não apaga a leitura mais nova
+    TEST_ASSERT_FALSE(q.push(sent));
+    TEST_ASSERT_EQUAL(1, q.size());
+    q.pop(out);
+    TEST_ASSERT_EQUAL(150, out.capturedAt);
+
+    // millis() dando a volta: mais novo continua vencendo
+    q.push(frame(3, (unsigned long)-16, 1.0f));
+    TEST_ASSERT_TRUE(q.push(frame(3, 0x10, 2.0f)));
+    q.pop(out);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, out.soilMoisture);
+
+    uint32_t coalesced, dropped, alarms;
+    q.getStatistics(coalesced, dropped, alarms);
+    TEST_ASSERT_EQUAL(1, dropped);
+}
+
+static void test_alarms_first_and_never_coalesced() {
+    AgriNodeTxQueue q;
+    q.push(frame(1, 100, 40.0f));
+    q.push(frame(2, 110, 50.0f, true));
+    q.push(frame(2, 120, 20.0f, true));
+    q.push(frame(2, 130, 21.0f));               // normal do mesmo nó: entrada própria
+    TEST_ASSERT_EQUAL(4, q.size());
+    TEST_ASSERT_TRUE(q.hasPending(2));
+
+    TxFrame out;
+    q.pop(out);
+    TEST_ASSERT_TRUE(out.alarm);
+    TEST_ASSERT_EQUAL(110, out.capturedAt);
+    q.pop(out);
+    TEST_ASSERT_TRUE(out.alarm);
+    TEST_ASSERT_EQUAL(120, out.capturedAt);
+    q.pop(out);
+    TEST_ASSERT_FALSE(out.alarm);
+    TEST_ASSERT_EQUAL(1, out.nodeId);
+
+    uint32_t coalesced, dropped, alarms;
+    q.getStatistics(coalesced, dropped, alarms);
+    TEST_ASSERT_EQUAL(0, coalesced);
+    TEST_ASSERT_EQUAL(2, alarms);
+}
+
+static void test_full_queue_evicts_oldest_normal() {
+    AgriNodeTxQueue q;
+    for (uint16_t n = 0; n < TX_QUEUE_CAPACITY - 1; n++) q.push(frame(10 + n, 100 + n, 0.0f));
+    q.push(frame(1, 200, 0.0f, true));
+    TEST_ASSERT_EQUAL(TX_QUEUE_CAPACITY, q.size());
+
+    // Cheia: novo nó entra, o normal mais antigo (nó 10) sai; o alarme fica
+    TEST_ASSERT_TRUE(q.push(frame(99, 300, 0.0f)));
+    TEST_ASSERT_EQUAL(TX_QUEUE_CAPACITY, q.size());
+    TEST_ASSERT_FALSE(q.hasPending(10));
+    TEST_ASSERT_TRUE(q.hasPending(99));
+
+    TxFrame out;
+    q.pop(out);
+    TEST_ASSERT_TRUE(out.alarm);
+
+    uint32_t coalesced, dropped, alarms;
+    q.getStatistics(coalesced, dropped, alarms);
+    TEST_ASSERT_EQUAL(1, dropped);
+}
+
+static void test_full_of_alarms() {
+    AgriNodeTxQueue q;
+    for (uint16_t n = 0; n < TX_QUEUE_CAPACITY; n++) q.push(frame(n, 100 + n, 0.0f, true));
+
+    // Só alarmes: frame normal é recusado, alarme novo tira o alarme mais antigo
+    TEST_ASSERT_FALSE(q.push(frame(50, 500, 0.0f)));
+    TEST_ASSERT_TRUE(q.push(frame(51, 501, 0.0f, true)));
+    TEST_ASSERT_EQUAL(TX_QUEUE_CAPACITY, q.size());
+
+    TxFrame out;
+    q.pop(out);
+    TEST_ASSERT_EQUAL(1, out.nodeId);           // o alarme do nó 0 foi descartado
+
+    uint32_t coalesced, dropped, alarms;
+    q.getStatistics(coalesced, dropped, alarms);
+    TEST_ASSERT_EQUAL(2, dropped);
+    TEST_ASSERT_EQUAL(TX_QUEUE_CAPACITY + 1, alarms);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_coalesce_in_place);
+    RUN_TEST(test_stale_repush_rejected);
+    RUN_TEST(test_alarms_first_and_never_coalesced);
+    RUN_TEST(test_full_queue_evicts_oldest_normal);
+    RUN_TEST(test_full_of_alarms);
+    return UNITY_END();
+}
@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+"""
+Simboliza o dump do profiler por amostragem (AgriNode_Profiler) contra o firmware.elf.
+
+Lê os blocos "[PROF] BEGIN ... [PROF] END" de um log da serial, soma as
+janelas (ou usa só a última), agrupa os PCs por função via nm e imprime:
+  - as funções mais amostradas (% do tempo de CPU);
+  - um resumo por categoria (float emulado, TLS, SPI, UART/log, WiFi/lwIP, ocioso...);
+  - opcionalmente, as linhas de código mais quentes (addr2line).
+
+Uso:
+  pio run -e esp32-c3-profile -t upload && pio device monitor | tee serial.log
+  python3 tools/profile_symbolize.py serial.log .pio/build/esp32-c3-profile/firmware.elf
+  python3 tools/profile_symbolize.py serial.log firmware.elf --last --top 40 --lines 15
+
+As ferramentas padrão são as do toolchain RISC-V do PlatformIO
+(~/.platformio/packages/toolchain-riscv32-esp/bin); use --nm/--addr2line/--cxxfilt
+se não estiverem no PATH.
+"""
+import argparse
+import bisect
+import re
+import subprocess
+import sys
+from collections import Counter
+
+BEGIN_RE = re.compile(r"\[PROF\] BEGIN hz=(\d+) ms=(\d+) samples=(\d+) dropped=(\d+)")
+SAMPLE_RE = re.compile(r"\[PROF\] 0x([0-9a-fA-F]+) (\d+)")
+END_RE = re.compile(r"\[PROF\] END")
+
+# Ordem importa: a primeira categoria que casar com o nome da função vence
+CATEGORIES = [
+    ("ocioso", r"^(prvIdleTask|esp_cpu_wait_for_intr|vApplicationIdleHook|esp_vApplicationIdleHook|"
+               r"esp_pm_impl_waiti|cpu_ll_waiti|vTaskDelay|delay)$"),
+    ("float emulado", r"^(__(add|sub|mul|div|neg|cmp|eq|ne|lt|le|gt|ge|unord)[sd]f[23]|"
+                      r"__(fix|fixuns|float|floatun|extend|trunc)\w*[sd]f\w*|"
+                      r"__ieee754_\w+|__kernel_\w+|(sin|cos|tan|exp|log|pow|sqrt|fabs|floor)f?)$"),
+    ("TLS (mbedTLS)", r"^(mbedtls_|mpi_|ecp_|esp_mpi_|esp_sha|esp_aes|sha256_|aes_)"),
+    ("SPI / LoRa", r"^(spi|SPIClass|LoRaClass|_ZN8SPIClass|_ZN9LoRaClass)"),
+    ("UART / log", r"^(uart_|HardwareSerial|_ZN14HardwareSerial|HWCDC|_ZN5HWCDC|usb_serial_jtag|"
+                   r"_?v?s?n?printf|_svfprintf_r|_vfprintf_r|__sfvwrite_r|_printf_i|log_printf|"
+                   r"esp_rom_printf|_ZN5Print)"),
+    ("WiFi / lwIP", r"^(lwip_|tcp_|udp_|ip4_|pbuf_|netconn_|esp_wifi|wifi_|ieee80211|ppTask|pp_|"
+                    r"lmac|hal_mac|esf_buf|ic_|wdev_|dns_|sys_arch|netif_)"),
+    ("FreeRTOS / ISR", r"^(vPort|xPort|xTask|vTask|uxTask|xQueue|vList|prv|_interrupt_handler|"
+                       r"_global_interrupt_handler|esp_intr|intr_handler|timer_|onProfilerTick)"),
+    ("heap", r"^(heap_caps_|multi_heap_|tlsf_|malloc|free|realloc|calloc|_malloc_r|_free_r)"),
+    ("AgriNode", r"^(_ZN\d*AgriNode|AgriNode|_Z\w*(loop|setup)|loop|setup)"),
+]
+CATEGORY_RES = [(name, re.compile(rx)) for name, rx in CATEGORIES]
+
+
+def parse_dumps(path):
+    """Devolve a lista de janelas: (cabeçalho, Counter{pc: contagem})."""
+    windows = []
+    current = None
+    with open(path, "r", errors="replace") as f:
+        for line in f:
+            m = BEGIN_RE.search(line)
+            if m:
+                hz, ms, samples, dropped = (int(x) for x in m.groups())
+                current = ({"hz": hz, "ms": ms, "samples": samples, "dropped": dropped}, Counter())
+                continue
+            if current is None:
+                continue
+            m = SAMPLE_RE.search(line)
+            if m:
+                current[1][int(m.group(1), 16)] += int(m.group(2))
+                continue
+            if END_RE.search(line):
+                windows.append(current)
+                current = None
+    return windows
+
+
+def load_symbols(nm, cxxfilt, elf):
+    """Funções (endereço, tamanho, nome demangled, nome cru) ordenadas por endereço.
+
+    Inclui símbolos absolutos ('A'): no ESP32-C3 a emulação de float da libgcc
+    e parte da libc estão na ROM e chegam ao ELF só como endereço fixo, sem tamanho.
+    """
+    out = subprocess.run([nm, "-n", "-S", "--defined-only", elf],
+                         check=True, capture_output=True, text=True).stdout
+    entries = []
+    for line in out.splitlines():
+        f = line.split()
+        if len(f) == 4:
+            addr, size, kind, name = int(f[0], 16), int(f[1], 16), f[2], f[3]
+        elif len(f) == 3:
+            addr, size, kind, name = int(f[0], 16), 0, f[1], f[2]
+        else:
+            continue
+        if kind in "tTwWA":
+            entries.append((addr, size, name))
+
+    mangled = [e[2] for e in entries]
+    try:
+        pretty = subprocess.run([cxxfilt], input="\n".join(mangled), check=True,
+                                capture_output=True, text=True).stdout.splitlines()
+    except (OSError, subprocess.CalledProcessError):
+        pretty = []
+    if len(pretty) != len(mangled):
+        pretty = mangled
+
+    syms = [(a, s, p, m) for (a, s, m), p in zip(entries, pretty)]
+    syms.sort()
+    return syms
+
+
+def lookup(syms, starts, pc):
+    i = bisect.bisect_right(starts, pc) - 1
+    if i < 0:
+        return None
+    addr, size, name, mangled = syms[i]
+    if size and pc >= addr + size:
+        return None
+    return name, mangled
+
+
+def categorize(name, mangled):
+    base = name.split("(")[0].split("::")[-1]
+    for cat, rx in CATEGORY_RES:
+        if rx.search(mangled) or rx.search(name) or rx.search(base):
+            return cat
+    return "outros"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("log", help="log da serial com os blocos [PROF]")
+    ap.add_argument("elf", help="firmware.elf do mesmo build")
+    ap.add_argument("--last", action="store_true", help="usa só a última janela em vez de somar todas")
+    ap.add_argument("--top", type=int, default=25, help="funções listadas")
+    ap.add_argument("--lines", type=int, default=0, help="linhas de código mais quentes (addr2line)")
+    ap.add_argument("--nm", default="riscv32-esp-elf-nm")
+    ap.add_argument("--addr2line", default="riscv32-esp-elf-addr2line")
+    ap.add_argument("--cxxfilt", default="riscv32-esp-elf-c++filt")
+    args = ap.parse_args()
+
+    windows = parse_dumps(args.log)
+    if not windows:
+        sys.exit("nenhum bloco [PROF] BEGIN/END encontrado em %s" % args.log)
+    if args.last:
+        windows = windows[-1:]
+
+    hist = Counter()
+    total_ms = samples = dropped = 0
+    for hdr, counts in windows:
+        hist.update(counts)
+        total_ms += hdr["ms"]
+        samples += hdr["samples"]
+        dropped += hdr["dropped"]
+    hz = windows[-1][0]["hz"]
+
+    try:
+        syms = load_symbols(args.nm, args.cxxfilt, args.elf)
+    except (OSError, subprocess.CalledProcessError) as e:
+        sys.exit("falha ao rodar %s: %s (use --nm)" % (args.nm, e))
+    starts = [s[0] for s in syms]
+
+    by_func = Counter()
+    by_cat = Counter()
+    unknown = 0
+    for pc, n in hist.items():
+        hit = lookup(syms, starts, pc)
+        if hit is None:
+            unknown += n
+            by_func["?? (0x%08x)" % pc] += n
+            by_cat["sem símbolo"] += n
+            continue
+        by_func[hit[0]] += n
+        by_cat[categorize(*hit)] += n
+
+    counted = sum(hist.values())
+    print("Janelas: %d | %.1f s a %d Hz | %d amostras (%d descartadas, %.1f%%) | %d PCs distintos"
+          % (len(windows), total_ms / 1000.0, hz, samples, dropped,
+             100.0 * dropped / max(samples, 1), len(hist)))
+    print()
+    print("%-7s %8s  %s" % ("%", "amostras", "categoria"))
+    for cat, n in by_cat.most_common():
+        print("%6.2f%% %8d  %s" % (100.0 * n / counted, n, cat))
+    print()
+    print("%-7s %8s  %s" % ("%", "amostras", "função"))
+    for name, n in by_func.most_common(args.top):
+        print("%6.2f%% %8d  %s" % (100.0 * n / counted, n, name))
+
+    if args.lines > 0:
+        hot = [pc for pc, _ in hist.most_common(args.lines)]
+        try:
+            out = subprocess.run([args.addr2line, "-f", "-C", "-e", args.elf]
+                                 + ["0x%x" % pc for pc in hot],
+                                 check=True, capture_output=True, text=True).stdout.splitlines()
+        except (OSError, subprocess.CalledProcessError) as e:
+            sys.exit("falha ao rodar %s: %s (use --addr2line)" % (args.addr2line, e))
+        print()
+        print("%-7s %8s  %-10s  %s" % ("%", "amostras", "pc", "linha"))
+        for i, pc in enumerate(hot):
+            func = out[2 * i] if 2 * i < len(out) else "??"
+            where = out[2 * i + 1] if 2 * i + 1 < len(out) else "??"
+            print("%6.2f%% %8d  0x%08x  %s (%s)" % (100.0 * hist[pc] / counted, hist[pc], pc, where, func))
+
+    if unknown:
+        print("\n%d amostras fora de qualquer função do ELF (ROM ou build diferente?)" % unknown,
+              file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+"""
+Stand-in local do Web App do Apps Script (GOOGLE_SHEETS_URL) para testar o uplink sem internet.
+
+Emula o comportamento que o firmware encontra em script.google.com:
+  GET /macros/s/<id>/exec?temp=..&ts=..  -> 302 para /macros/echo?user_content_key=..
+  GET /macros/echo?..                     -> 200 com a página de resposta
+e permite injetar latência, erros 5xx e cota (429), registrando o tempo de cada requisição em CSV.
+
+Uso:
+  python3 tools/sheets_standin.py --port 8080 --latency-ms 300 --jitter-ms 200 \
+      --error-rate 0.05 --quota-per-min 20 --csv timings.csv
+  # HTTPS (certificado autoassinado; o firmware usa setInsecure()):
+  python3 tools/sheets_standin.py --port 8443 --cert cert.pem --key key.pem
+
+No firmware, compile o ambiente esp32-c3-standin (platformio.ini) apontando
+GOOGLE_SHEETS_URL para o IP desta máquina.
+"""
+import argparse
+import csv
+import random
+import secrets
+import signal
+import ssl
+import statistics
+import sys
+import threading
+import time
+from collections import deque
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+# Página parecida com a que o Apps Script devolve (HTML grande) para exercitar a leitura limitada
+ECHO_BODY = ("<!DOCTYPE html><html><head><title>OK</title></head><body>"
+             + "<!-- padding -->" * 400 + "OK</body></html>")
+
+
+class StandinState:
+    def __init__(self, args):
+        self.args = args
+        self.lock = threading.Lock()
+        self.window = deque()           # instantes das execuções aceitas no último minuto
+        self.rows = []
+        self.rows_seq = 0
+        self.csv_file = None
+        self.csv_writer = None
+        if args.csv:
+            self.csv_file = open(args.csv, "w", newline="")
+            self.csv_writer = csv.writer(self.csv_file)
+            self.csv_writer.writerow(["seq", "t_unix", "client", "route", "status",
+                                      "injected_ms", "handler_ms", "temp", "ts"])
+
+    def take_quota(self):
+        """Janela deslizante de 60 s, como a cota de execuções do Apps Script."""
+        if self.args.quota_per_min <= 0:
+            return True
+        now = time.monotonic()
+        with self.lock:
+            while self.window and now - self.window[0] > 60.0:
+                self.window.popleft()
+            if len(self.window) >= self.args.quota_per_min:
+                return False
+            self.window.append(now)
+            return True
+
+    def record(self, client, route, status, injected_ms, handler_ms, temp, ts):
+        with self.lock:
+            self.rows_seq += 1
+            row = [self.rows_seq, f"{time.time():.3f}", client, route, status,
+                   f"{injected_ms:.1f}", f"{handler_ms:.1f}", temp, ts]
+            self.rows.append((route, status, handler_ms))
+            if self.csv_writer:
+                self.csv_writer.writerow(row)
+                self.csv_file.flush()
+        print(f"[{row[0]:5d}] {client:15s} {route:5s} {status} "
+              f"{handler_ms:7.1f} ms  temp={temp} ts={ts}", flush=True)
+
+    def summary(self):
+        with self.lock:
+            rows = list(self.rows)
+        if not rows:
+            print("Nenhuma requisição registrada.")
+            return
+        print("\n==== RESUMO ====")
+        for route in ("exec", "echo"):
+            times = [r[2] for r in rows if r[0] == route]
+            if not times:
+                continue
+            times.sort()
+            p95 = times[min(len(times) - 1, int(0.95 * len(times)))]
+            print(f"  {route}: n={len(times)} média={statistics.mean(times):.1f} ms "
+                  f"p50={statistics.median(times):.1f} ms p95={p95:.1f} ms max={times[-1]:.1f} ms")
+        codes = {}
+        for r in rows:
+            codes[r[1]] = codes.get(r[1], 0) + 1
+        print("  códigos: " + ", ".join(f"{k}={v}" for k, v in sorted(codes.items())))
+
+
+def make_handler(state):
+    args = state.args
+
+    class Handler(BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+        server_version = "GSE"
+
+        def log_message(self, fmt, *a):    # o registro próprio já imprime cada requisição
+            pass
+
+        def _inject(self):
+            delay = max(0.0, random.gauss(args.latency_ms, args.jitter_ms)) if args.jitter_ms else args.latency_ms
+            if delay > 0:
+                time.sleep(delay / 1000.0)
+            return delay
+
+        def _send(self, status, body, headers=None):
+            data = body.encode()
+            self.send_response(status)
+            self.send_header("Content-Type", "text/html; charset=utf-8")
+            self.send_header("Content-Length", str(len(data)))
+            for k, v in (headers or {}).items():
+                self.send_header(k, v)
+            self.end_headers()
+            self.wfile.write(data)
+
+        def do_GET(self):
+            t0 = time.perf_counter()
+            url = urlparse(self.path)
+            q = parse_qs(url.query)
+            temp = q.get("temp", [""])[0]
+            ts = q.get("ts", [""])[0]
+            client = self.client_address[0]
+
+            if url.path.startswith("/macros/s/") and url.path.endswith("/exec"):
+                route = "exec"
+                injected = self._inject()
+                if not state.take_quota():
+                    status = 429
+                    self._send(status, "Service invoked too many times for one day/minute.")
+                elif random.random() < args.error_rate:
+                    status = random.choice((500, 502, 503))
+                    self._send(status, "<html><body>Internal error</body></html>")
+                else:
+                    # Apps Script sempre redireciona o resultado para googleusercontent
+                    status = 302
+                    scheme = "https" if args.cert else "http"
+                    host = self.headers.get("Host", f"localhost:{args.port}")
+                    key = secrets.token_urlsafe(24)
+                    location = f"{scheme}://{host}/macros/echo?user_content_key={key}&temp={temp}"
+                    self._send(status, f'<HTML><BODY>Moved <A HREF="{location}">here</A></BODY></HTML>',
+                               {"Location": location})
+            elif url.path == "/macros/echo":
+                route = "echo"
+                injected = self._inject() if args.echo_latency else 0.0
+                status = 200
+                self._send(status, ECHO_BODY)
+            else:
+                route = "other"
+                injected = 0.0
+                status = 404
+                self._send(status, "Not Found")
+
+            state.record(client, route, status, injected,
+                         (time.perf_counter() - t0) * 1000.0, temp, ts)
+
+    return Handler
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("--bind", default="0.0.0.0")
+    ap.add_argument("--port", type=int, default=8080)
+    ap.add_argument("--cert", help="certificado PEM (ativa HTTPS)")
+    ap.add_argument("--key", help="chave privada PEM")
+    ap.add_argument("--latency-ms", type=float, default=0.0, help="latência média injetada em /exec")
+    ap.add_argument("--jitter-ms", type=float, default=0.0, help="desvio padrão da latência")
+    ap.add_argument("--echo-latency", action="store_true", help="injeta latência também no redirect")
+    ap.add_argument("--error-rate", type=float, default=0.0, help="fração de respostas 5xx (0..1)")
+    ap.add_argument("--quota-per-min", type=int, default=0, help="execuções/min antes de 429 (0 = sem cota)")
+    ap.add_argument("--csv", help="arquivo CSV com o tempo de cada requisição")
+    ap.add_argument("--seed", type=int, help="semente para reproduzir a mesma sequência de erros/latências")
+    args = ap.parse_args()
+
+    if args.seed is not None:
+        random.seed(args.seed)
+
+    state = StandinState(args)
+    server = ThreadingHTTPServer((args.bind, args.port), make_handler(state))
+    if args.cert:
+        ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        ctx.load_cert_chain(args.cert, args.key)
+        server.socket = ctx.wrap_socket(server.socket, server_side=True)
+
+    # SIGTERM/SIGINT (inclusive em background) encerram com o resumo impresso
+    def stop(*_):
+        raise KeyboardInterrupt
+    signal.signal(signal.SIGTERM, stop)
+    signal.signal(signal.SIGINT, stop)
+
+    scheme = "https" if args.cert else "http"
+    print(f"Stand-in do Apps Script em {scheme}://{args.bind}:{args.port}/macros/s/standin/exec", flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.server_close()
+        state.summary()
+        if state.csv_file:
+            state.csv_file.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())